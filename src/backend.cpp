@@ -15,37 +15,200 @@
 #include "cfg.h"
 #include "status.h"
 #include "jenkins.h"
+#include "leds.h"
 
 #include "backend.h"
 
 #define BACKEND_HEARTBEAT_INTERVAL 5000
 #define BACKEND_HEARTBEAT_TIMEOUT (3 * BACKEND_HEARTBEAT_INTERVAL)
 
-static uint32_t sLastHello;
-static uint32_t sLastHeartbeat;
-static uint32_t sBytesReceived;
-static int      sBackendBufMax;
-static uint32_t sBackendBufFull;
-static BACKEND_STATUS_t sBackendStatus;
+// heartbeats arriving this much early or late are considered jitter
+#define BACKEND_HEARTBEAT_JITTER (BACKEND_HEARTBEAT_INTERVAL / 2)
 
-void backendDisconnect(const bool keepStatus)
+// number of jittery heartbeats (out of the last 8) that make us think the stream is buffered (by some proxy)
+#define BACKEND_JITTER_THRS 3
+
+// time [ms] to wait for the "hello" in streaming mode
+#define BACKEND_HELLO_TIMEOUT 20000
+
+// time [ms] after which to try streaming mode again
+#define BACKEND_LONGPOLL_RETRY (4 * 3600 * 1000)
+
+//! state of one subscription (connection to a backend)
+typedef struct BACKEND_SUB_s
 {
-    DEBUG("backend: disconnect");
-    const uint32_t now = millis();
+    uint32_t         lastHello;
+    uint32_t         lastHeartbeat;
+    uint32_t         bytesReceived;
+    int              bufMax;
+    uint32_t         bufFull;
+    BACKEND_STATUS_t status;
+    uint32_t         connectTime;
+    int              lastHeartbeatCnt;
+    bool             jitterSkip; // don't judge the next heartbeat, we weren't listening for a while
+    uint8_t          jitterHist;
+    uint32_t         jitterMax;
+    BACKEND_MODE_t   mode;
+    uint32_t         modeSince;
+    uint32_t         pollGen;
+    uint32_t         numPolls;
+    char             report[200]; // pending report to send back to the backend ("" = none)
+    char             buf[4096]; // we may or may not get full lines in resp from the socket
+} BACKEND_SUB_t;
+
+static BACKEND_SUB_t sBackendSubs[CONFIG_NUM_BACKENDS];
+
+void backendDisconnect(const int ix, const bool keepStatus)
+{
+    BACKEND_SUB_t *pSub = &sBackendSubs[ix];
+    DEBUG("backend: %d disconnect", ix);
     if (keepStatus)
     {
-        jenkinsStateUnknownAll();
+        jenkinsStateUnknownRange(ix * BACKEND_NUM_CH, BACKEND_NUM_CH);
     }
     else
     {
-        jenkinsClearAll();
+        jenkinsClearRange(ix * BACKEND_NUM_CH, BACKEND_NUM_CH);
+    }
+    backendReset(ix);
+    pSub->pollGen = 0;
+}
+
+void backendReset(const int ix)
+{
+    BACKEND_SUB_t *pSub = &sBackendSubs[ix];
+    DEBUG("backend: %d reset", ix);
+    const uint32_t now = millis();
+    pSub->buf[0] = '\0';
+    pSub->lastHeartbeat = 0;
+    pSub->lastHello = 0;
+    pSub->bytesReceived = 0;
+    pSub->bufMax = 0;
+    pSub->bufFull = 0;
+    pSub->status = BACKEND_STATUS_NONE;
+    pSub->connectTime = now;
+    pSub->lastHeartbeatCnt = 0;
+    pSub->jitterSkip = false;
+    pSub->jitterHist = 0;
+    pSub->jitterMax = 0;
+}
+
+BACKEND_MODE_t backendConnectMode(const int ix)
+{
+    BACKEND_SUB_t *pSub = &sBackendSubs[ix];
+    const uint32_t now = millis();
+
+    // try streaming again every once in a while
+    if ( (pSub->mode == BACKEND_MODE_LONGPOLL) && ((now - pSub->modeSince) > BACKEND_LONGPOLL_RETRY) )
+    {
+        PRINT("backend: %d mode longpoll -> stream", ix);
+        pSub->mode = BACKEND_MODE_STREAM;
+        pSub->modeSince = now;
+        pSub->pollGen = 0;
+    }
+    return pSub->mode;
+}
+
+BACKEND_MODE_t backendGetMode(const int ix)
+{
+    return sBackendSubs[ix].mode;
+}
+
+uint32_t backendGetPollGen(const int ix)
+{
+    return sBackendSubs[ix].pollGen;
+}
+
+uint32_t backendGetLastHeartbeat(const int ix)
+{
+    return sBackendSubs[ix].lastHeartbeat;
+}
+
+bool backendGetReport(const int ix, char *report, const int size)
+{
+    BACKEND_SUB_t *pSub = &sBackendSubs[ix];
+    if (pSub->report[0] == '\0')
+    {
+        return false;
+    }
+    strncpy(report, pSub->report, size);
+    report[size - 1] = '\0';
+    pSub->report[0] = '\0';
+    return true;
+}
+
+static const char *sBackendModeStr(const BACKEND_MODE_t mode)
+{
+    switch (mode)
+    {
+        case BACKEND_MODE_STREAM:   return PSTR("stream");
+        case BACKEND_MODE_LONGPOLL: return PSTR("longpoll");
+        default:                    return PSTR("???");
     }
-    sLastHeartbeat = 0;
-    sLastHello = 0;
-    sBytesReceived = 0;
-    sBackendBufMax = 0;
-    sBackendBufFull = 0;
-    sBackendStatus = BACKEND_STATUS_NONE;
+}
+
+// the stream seems to be held back by some proxy, switch to long-polling
+static void sBackendCheckBuffered(const int ix, const bool stalled)
+{
+    BACKEND_SUB_t *pSub = &sBackendSubs[ix];
+    const int numJitter = __builtin_popcount(pSub->jitterHist);
+    if ( (pSub->mode == BACKEND_MODE_STREAM) && (stalled || (numJitter >= BACKEND_JITTER_THRS)) )
+    {
+        WARNING("backend: %d stream buffered (stalled=%d, jitter=%d/8, max=%u), mode stream -> longpoll",
+            ix, stalled, numJitter, pSub->jitterMax);
+        pSub->mode = BACKEND_MODE_LONGPOLL;
+        pSub->modeSince = millis();
+        pSub->pollGen = 0;
+    }
+}
+
+void backendStalled(const int ix)
+{
+    sBackendCheckBuffered(ix, true);
+}
+
+void backendPause(const int ix, const uint32_t dt)
+{
+    BACKEND_SUB_t *pSub = &sBackendSubs[ix];
+    // move the timeouts, the data that arrived meanwhile is waiting in the socket
+    pSub->connectTime += dt;
+    if (pSub->lastHeartbeat != 0)
+    {
+        pSub->lastHeartbeat += dt;
+    }
+    else if (pSub->lastHello != 0)
+    {
+        pSub->lastHello += dt;
+    }
+    // the heartbeats received meanwhile will arrive in one chunk
+    pSub->jitterSkip = true;
+}
+
+BACKEND_STATUS_t backendCheck(const int ix)
+{
+    BACKEND_SUB_t *pSub = &sBackendSubs[ix];
+    // in long-poll mode heartbeats arrive in bursts with the response, see wifiConnectBackend()
+    if (pSub->mode != BACKEND_MODE_STREAM)
+    {
+        return pSub->status;
+    }
+
+    const uint32_t now = millis();
+    BACKEND_STATUS_t res = pSub->status;
+    if ( (pSub->lastHello == 0) && ((now - pSub->connectTime) > BACKEND_HELLO_TIMEOUT) )
+    {
+        ERROR("backend: %d no hello", ix);
+        sBackendCheckBuffered(ix, true);
+        res = BACKEND_STATUS_FAIL;
+    }
+    else if ( (pSub->lastHello != 0) && ((now - (pSub->lastHeartbeat != 0 ? pSub->lastHeartbeat : pSub->lastHello)) > BACKEND_HEARTBEAT_TIMEOUT) )
+    {
+        ERROR("backend: %d lost heartbeat", ix);
+        sBackendCheckBuffered(ix, false);
+        res = BACKEND_STATUS_FAIL;
+    }
+    pSub->status = res;
+    return res;
 }
 
 static const char *sBackendStatusStr(const BACKEND_STATUS_t status)
@@ -58,6 +221,7 @@ static const char *sBackendStatusStr(const BACKEND_STATUS_t status)
         case BACKEND_STATUS_RECONNECT:  return PSTR("RECONNECT");
         case BACKEND_STATUS_FAIL:       return PSTR("FAIL");
         case BACKEND_STATUS_RXBUF:      return PSTR("RXBUF");
+        case BACKEND_STATUS_POLLED:     return PSTR("POLLED");
         default:                        return PSTR("???");
     }
 }
@@ -65,16 +229,23 @@ static const char *sBackendStatusStr(const BACKEND_STATUS_t status)
 static void sBackendMonStatus(void)
 {
     const uint32_t now = millis();
-    DEBUG("mon: backend: status=%s, uptime=%u (%s), heartbeat=%u, bytes=%u, bufMax=%d, bufFull=%u",
-        sBackendStatusStr(sBackendStatus),
-        sLastHello ? now - sLastHello : 0,
-        sLastHello ? ((now - sLastHello) > (1000 * CONFIG_STABLE_CONN_THRS) ? PSTR("stable") : PSTR("unstable") ) : PSTR("n/a"),
-        sLastHeartbeat ? now - sLastHeartbeat : 0, sBytesReceived, sBackendBufMax, sBackendBufFull);
+    for (int ix = 0; ix < NUMOF(sBackendSubs); ix++)
+    {
+        const BACKEND_SUB_t *pSub = &sBackendSubs[ix];
+        DEBUG("mon: backend: %d status=%s, uptime=%u (%s), heartbeat=%u, bytes=%u, bufMax=%d, bufFull=%u",
+            ix, sBackendStatusStr(pSub->status),
+            pSub->lastHello ? now - pSub->lastHello : 0,
+            pSub->lastHello ? ((now - pSub->lastHello) > (1000 * CONFIG_STABLE_CONN_THRS) ? PSTR("stable") : PSTR("unstable") ) : PSTR("n/a"),
+            pSub->lastHeartbeat ? now - pSub->lastHeartbeat : 0, pSub->bytesReceived, pSub->bufMax, pSub->bufFull);
+        DEBUG("mon: backend: %d mode=%s (%u), gen=%u, polls=%u, jitter=%d/8, jitterMax=%u",
+            ix, sBackendModeStr(pSub->mode), (now - pSub->modeSince) / 1000, pSub->pollGen, pSub->numPolls,
+            __builtin_popcount(pSub->jitterHist), pSub->jitterMax);
+    }
 }
 
 
 // forward declarations
-void sBackendProcessStatus(const char *json);
+void sBackendProcessStatus(const int subIx, const char *json);
 
 static void sBackendHandleSetTime(const char *timestampStr)
 {
@@ -109,47 +280,47 @@ static char *strrstr(char *haystack, const char *needle)
 }
 
 // process response from backend
-BACKEND_STATUS_t backendHandle(char *resp, const int len)
+BACKEND_STATUS_t backendHandle(const int ix, char *resp, const int len)
 {
+    BACKEND_SUB_t *pSub = &sBackendSubs[ix];
     BACKEND_STATUS_t res = BACKEND_STATUS_OKAY;
-    sBytesReceived += len;
+    pSub->bytesReceived += len;
 
     const uint32_t now = millis();
 
     //DEBUG("backendHandle() [%d] %s", len, resp);
 
-    // backend buffer (we may or may not get full lines in resp from the socket
-    static char sBackendBuf[4096];
-    const int backendBufLen = strlen(sBackendBuf);
+    const int backendBufLen = strlen(pSub->buf);
     const int backendBufLenNew = backendBufLen + len;
-    if (sizeof(sBackendBuf) > backendBufLenNew)
+    if (sizeof(pSub->buf) > backendBufLenNew)
     {
-        strncat(sBackendBuf, resp, sizeof(sBackendBuf) - 2);
-        if (backendBufLenNew > sBackendBufMax)
+        strncat(pSub->buf, resp, sizeof(pSub->buf) - 2);
+        if (backendBufLenNew > pSub->bufMax)
         {
-            sBackendBufMax = backendBufLenNew;
+            pSub->bufMax = backendBufLenNew;
         }
     }
     else
     {
-        WARNING("backend: rx buf");
-        sBackendBuf[0] = '\0';
-        sBackendBufFull++;
-        sBackendStatus = BACKEND_STATUS_RXBUF;
+        WARNING("backend: %d rx buf", ix);
+        pSub->buf[0] = '\0';
+        pSub->bufFull++;
+        pSub->status = BACKEND_STATUS_RXBUF;
         return BACKEND_STATUS_RXBUF;
     }
 
     // look for known server data
-    char *pHello     = strstr_P(sBackendBuf, PSTR("\r\n""hello "));
-    char *pConfig    = strstr_P(sBackendBuf, PSTR("\r\n""config "));
-    char *pStatus    = strstr_P(sBackendBuf, PSTR("\r\n""status "));
-    char *pHeartbeat = strstr_P(sBackendBuf, PSTR("\r\n""heartbeat "));
-    char *pError     = strstr_P(sBackendBuf, PSTR("\r\n""error "));
-    char *pReconnect = strstr_P(sBackendBuf, PSTR("\r\n""reconnect "));
-    char *pCommand   = strstr_P(sBackendBuf, PSTR("\r\n""command "));
+    char *pHello     = strstr_P(pSub->buf, PSTR("\r\n""hello "));
+    char *pConfig    = strstr_P(pSub->buf, PSTR("\r\n""config "));
+    char *pStatus    = strstr_P(pSub->buf, PSTR("\r\n""status "));
+    char *pHeartbeat = strstr_P(pSub->buf, PSTR("\r\n""heartbeat "));
+    char *pError     = strstr_P(pSub->buf, PSTR("\r\n""error "));
+    char *pReconnect = strstr_P(pSub->buf, PSTR("\r\n""reconnect "));
+    char *pCommand   = strstr_P(pSub->buf, PSTR("\r\n""command "));
+    char *pPoll      = strstr_P(pSub->buf, PSTR("\r\n""poll "));
 
     // end of lines, may or may not be followed by an incomplete next line (see below)
-    const char *lastCrLf = strrstr(sBackendBuf, "\r\n");
+    const char *lastCrLf = strrstr(pSub->buf, "\r\n");
 
     // \r\nhello 87e984 256 clientname\r\n
     if (pHello != NULL)
@@ -160,12 +331,12 @@ BACKEND_STATUS_t backendHandle(char *resp, const int len)
         {
             *endOfLine = '\0';
             const char *pMsg = &pHello[6];
-            DEBUG("backend: hello: %s", pMsg);
-            if (sLastHello == 0)
+            DEBUG("backend: %d hello: %s", ix, pMsg);
+            if (pSub->lastHello == 0)
             {
-                sLastHello = now;
+                pSub->lastHello = now;
                 res = BACKEND_STATUS_CONNECTED;
-                PRINT("backend: connected");
+                PRINT("backend: %d connected", ix);
             }
         }
     }
@@ -180,7 +351,7 @@ BACKEND_STATUS_t backendHandle(char *resp, const int len)
             *endOfLine = '\0';
             sBackendHandleSetTime(&pError[6]);
             const char *pMsg = &pError[6 + 10 + 1];
-            ERROR("backend: error: %s", pMsg);
+            ERROR("backend: %d error: %s", ix, pMsg);
         }
     }
 
@@ -193,7 +364,7 @@ BACKEND_STATUS_t backendHandle(char *resp, const int len)
         {
             *endOfLine = '\0';
             sBackendHandleSetTime(&pReconnect[10]);
-            PRINT("backend: reconnect");
+            PRINT("backend: %d reconnect", ix);
             res = BACKEND_STATUS_RECONNECT;
         }
     }
@@ -207,9 +378,26 @@ BACKEND_STATUS_t backendHandle(char *resp, const int len)
         {
             *endOfLine = '\0';
             sBackendHandleSetTime(&pHeartbeat[10]);
-            sLastHeartbeat = now;
             const char *pCnt = &pHeartbeat[10 + 10 + 1];
             DEBUG("backend: heartbeat %s", pCnt);
+
+            // late, early or missing (more than one in this chunk) heartbeats hint at a buffering proxy
+            const int cnt = atoi(pCnt);
+            if ( (pSub->mode == BACKEND_MODE_STREAM) && (pSub->lastHeartbeat != 0) && !pSub->jitterSkip )
+            {
+                const uint32_t dt = now - pSub->lastHeartbeat;
+                const uint32_t jitter = dt > BACKEND_HEARTBEAT_INTERVAL ?
+                    dt - BACKEND_HEARTBEAT_INTERVAL : BACKEND_HEARTBEAT_INTERVAL - dt;
+                const bool bad = (jitter > BACKEND_HEARTBEAT_JITTER) || (cnt != (pSub->lastHeartbeatCnt + 1));
+                pSub->jitterHist = (pSub->jitterHist << 1) | (bad ? 1 : 0);
+                if (jitter > pSub->jitterMax)
+                {
+                    pSub->jitterMax = jitter;
+                }
+            }
+            pSub->lastHeartbeatCnt = cnt;
+            pSub->lastHeartbeat = now;
+            pSub->jitterSkip = false;
         }
     }
 
@@ -223,11 +411,19 @@ BACKEND_STATUS_t backendHandle(char *resp, const int len)
             *endOfLine = '\0';
             sBackendHandleSetTime(&pConfig[7]);
             char *pJson = &pConfig[7 + 10 + 1];
-            DEBUG("backend: config");
-            statusNoise(STATUS_NOISE_OTHER);
-            if (!cfgApply(pJson))
+            // the device config comes from the first backend only
+            if (ix == 0)
             {
-                statusNoise(STATUS_NOISE_ERROR);
+                DEBUG("backend: config");
+                statusNoise(STATUS_NOISE_OTHER);
+                if (!cfgApply(pJson))
+                {
+                    statusNoise(STATUS_NOISE_ERROR);
+                }
+            }
+            else
+            {
+                DEBUG("backend: %d config (ignored)", ix);
             }
         }
     }
@@ -241,9 +437,9 @@ BACKEND_STATUS_t backendHandle(char *resp, const int len)
         {
             *endOfLine = '\0';
             sBackendHandleSetTime(&pStatus[7]);
-            DEBUG("backend: status");
+            DEBUG("backend: %d status", ix);
             char *pJson = &pStatus[7 + 10 + 1];
-            sBackendProcessStatus(pJson);
+            sBackendProcessStatus(ix, pJson);
         }
     }
 
@@ -302,6 +498,12 @@ BACKEND_STATUS_t backendHandle(char *resp, const int len)
                 PRINT("backend: command chewie/hello");
                 statusFx();
             }
+            else if (strcmp_P(pCmd, PSTR("profile")) == 0)
+            {
+                PRINT("backend: command profile");
+                // ..and send it back to the backend (see wifi.cpp)
+                ledsProfile(pSub->report, sizeof(pSub->report));
+            }
             else
             {
                 WARNING("backend: command %s ???", pCmd);
@@ -311,19 +513,39 @@ BACKEND_STATUS_t backendHandle(char *resp, const int len)
         }
     }
 
+    // "\r\npoll 1491146601 42\r\n" (long-poll response complete)
+    if (pPoll != NULL)
+    {
+        pPoll += 2;
+        char *endOfLine = strstr_P(pPoll, PSTR("\r\n"));
+        if (endOfLine != NULL)
+        {
+            *endOfLine = '\0';
+            sBackendHandleSetTime(&pPoll[5]);
+            pSub->pollGen = (uint32_t)atoi(&pPoll[5 + 10 + 1]);
+            pSub->numPolls++;
+            DEBUG("backend: %d poll %u", ix, pSub->pollGen);
+            if ( (res == BACKEND_STATUS_OKAY) || (res == BACKEND_STATUS_CONNECTED) )
+            {
+                res = BACKEND_STATUS_POLLED;
+            }
+        }
+    }
+
     // we must always receive the "hello" in the first chunk of data
-    if (sLastHello == 0)
+    if (pSub->lastHello == 0)
     {
-        ERROR("backend: no hello");
+        ERROR("backend: %d no hello", ix);
         res = BACKEND_STATUS_FAIL;
     }
 
     // check heartbeat
-    if (res == BACKEND_STATUS_OKAY)
+    if ( (res == BACKEND_STATUS_OKAY) && (pSub->mode == BACKEND_MODE_STREAM) )
     {
-        if ( (now - sLastHeartbeat) > BACKEND_HEARTBEAT_TIMEOUT )
+        if ( (now - pSub->lastHeartbeat) > BACKEND_HEARTBEAT_TIMEOUT )
         {
-            ERROR("backend: lost heartbeat");
+            ERROR("backend: %d lost heartbeat", ix);
+            sBackendCheckBuffered(ix, false);
             res = BACKEND_STATUS_FAIL;
         }
     }
@@ -331,29 +553,85 @@ BACKEND_STATUS_t backendHandle(char *resp, const int len)
     // keep remaining string in buffer
     if (lastCrLf != NULL)
     {
-        strcpy(sBackendBuf, lastCrLf);
+        strcpy(pSub->buf, lastCrLf);
     }
 
-    if (sBackendStatus != res)
+    if (pSub->status != res)
     {
-        DEBUG("backend: status %s -> %s", sBackendStatusStr(sBackendStatus), sBackendStatusStr(res));
+        DEBUG("backend: %d status %s -> %s", ix, sBackendStatusStr(pSub->status), sBackendStatusStr(res));
     }
 
-    sBackendStatus = res;
+    pSub->status = res;
     return res;
 }
 
+// pushes older than this [s] are ignored (replays)
+#define BACKEND_PUSH_MAXAGE 30
+
+void backendHandlePush(char *line)
+{
+    // "push 1491146601 server job state result 1491146500"
+    char *pSave = NULL;
+    const char *pCmd    = strtok_r(line, " ", &pSave);
+    const char *pTime   = strtok_r(NULL, " ", &pSave);
+    const char *pServer = strtok_r(NULL, " ", &pSave);
+    const char *pJob    = strtok_r(NULL, " ", &pSave);
+    const char *pState  = strtok_r(NULL, " ", &pSave);
+    const char *pResult = strtok_r(NULL, " ", &pSave);
+    const char *pTs     = strtok_r(NULL, " ", &pSave);
+    if ( (pTs == NULL) || (strcmp_P(pCmd, PSTR("push")) != 0) ||
+         (strlen(pServer) >= JENKINS_SERVER_LEN) || (strlen(pJob) >= JENKINS_JOBNAME_LEN) )
+    {
+        WARNING("backend: bad push");
+        return;
+    }
+
+    // we only know the time once the backend told us
+    const uint32_t now = getTime();
+    const int32_t age = (int32_t)(now - (uint32_t)atoi(pTime));
+    if ( (now > 1500000000) && ((age > BACKEND_PUSH_MAXAGE) || (age < -BACKEND_PUSH_MAXAGE)) )
+    {
+        WARNING("backend: old push (%ds)", age);
+        return;
+    }
+
+    JENKINS_INFO_t info;
+    memset(&info, 0, sizeof(info));
+    info.active = true;
+    strcpy(info.job, pJob);
+    strcpy(info.server, pServer);
+    info.state  = jenkinsStrToState(pState);
+    info.result = jenkinsStrToResult(pResult);
+    info.time   = atoi(pTs);
+    if (jenkinsPushInfo(&info) > 0)
+    {
+        statusNoise(STATUS_NOISE_OTHER);
+    }
+}
+
 // JSON size
 // [[99,"aaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaa","aaaaaaaaaaaaaaaaaaaaaaaaaaaaaa","aaaaaaaaaa","aaaaaaaaaa",1111111111],...]
 // https://arduinojson.org/v6/assistant/ --> 20x --> 4320
 //DynamicJsonDocument jsonDoc(4500);
 StaticJsonDocument<4500> jsonDoc;
 
-void sBackendProcessStatus(const char *json)
+void sBackendProcessStatus(const int subIx, const char *json)
 {
-    DEBUG("backend: [%d] %s", strlen(json), json);
+    DEBUG("backend: %d [%d] %s", subIx, strlen(json), json);
+
+    // each backend has its own range of channels
+    const int chOffs = subIx * BACKEND_NUM_CH;
     
+    const bool boost = !statusTonePlaying();
+    if (boost)
+    {
+        cpuBoost(true);
+    }
     DeserializationError error = deserializeJson(jsonDoc, json);
+    if (boost)
+    {
+        cpuBoost(false);
+    }
     if (error)
     {
         ERROR("backend: bad json: %s", error.c_str());
@@ -377,11 +655,11 @@ void sBackendProcessStatus(const char *json)
         if (arr[ix].is<JsonArray>())
         {
             // full info
-            if ( (arr[ix].size() == 6) && (arr[ix][0] >= 0) && (arr[ix][0] < CONFIG_NUM_CH) )
+            if ( (arr[ix].size() == 6) && (arr[ix][0] >= 0) && (arr[ix][0] < BACKEND_NUM_CH) )
             {
                 JENKINS_INFO_t info;
                 info.active = true;
-                info.chIx = arr[ix][0];
+                info.chIx = chOffs + arr[ix][0].as<int>();
                 snprintf(info.job, sizeof(info.job), "%s", arr[ix][1].as<char *>());
                 snprintf(info.server, sizeof(info.server), "%s", arr[ix][2].as<char *>());
                 info.state  = jenkinsStrToState(arr[ix][3]);
@@ -391,9 +669,9 @@ void sBackendProcessStatus(const char *json)
                 numUpdate++;
             }
             // only ch number, clear data
-            else if ( (arr[ix].size() == 1) && (arr[ix][0] >= 0) && (arr[ix][0] < CONFIG_NUM_CH) )
+            else if ( (arr[ix].size() == 1) && (arr[ix][0] >= 0) && (arr[ix][0] < BACKEND_NUM_CH) )
             {
-                const int   ch     = arr[ix][0];
+                const int   ch     = chOffs + arr[ix][0].as<int>();
                 JENKINS_INFO_t info;
                 info.active = false;
                 info.chIx = ch;
@@ -430,7 +708,11 @@ void sBackendProcessStatus(const char *json)
 
 void backendInit(void)
 {
-    DEBUG("backend: init");
+    DEBUG("backend: init (%d x %d channels)", CONFIG_NUM_BACKENDS, BACKEND_NUM_CH);
+    for (int ix = 0; ix < NUMOF(sBackendSubs); ix++)
+    {
+        sBackendSubs[ix].mode = BACKEND_MODE_STREAM;
+    }
     debugRegisterMon(sBackendMonStatus);
 }
 
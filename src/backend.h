@@ -15,6 +15,26 @@
 
 #include <Arduino.h>
 
+#include "config.h"
+
+#ifndef CONFIG_NUM_BACKENDS
+//! number of backends to connect to concurrently (each gets its own range of channels)
+#  define CONFIG_NUM_BACKENDS 1
+#endif
+
+#if (CONFIG_NUM_BACKENDS < 1) || (CONFIG_NUM_BACKENDS > 3)
+#  error Illegal CONFIG_NUM_BACKENDS!
+#endif
+#if defined(ESP8266) && (CONFIG_NUM_BACKENDS > 1)
+#  error Not enough memory for CONFIG_NUM_BACKENDS > 1 on ESP8266!
+#endif
+
+//! number of channels per backend
+#define BACKEND_NUM_CH (CONFIG_NUM_CH / CONFIG_NUM_BACKENDS)
+#if ((CONFIG_NUM_CH % CONFIG_NUM_BACKENDS) != 0)
+#  error CONFIG_NUM_CH must be a multiple of CONFIG_NUM_BACKENDS!
+#endif
+
 //! initialise
 void backendInit(void);
 
@@ -26,12 +46,60 @@ typedef enum BACKEND_STATUS_e
     BACKEND_STATUS_RECONNECT,
     BACKEND_STATUS_FAIL,
     BACKEND_STATUS_RXBUF,
+    BACKEND_STATUS_POLLED,
 
 } BACKEND_STATUS_t;
 
-BACKEND_STATUS_t backendHandle(char *resp, const int len);
+//! process data received from backend (subscription) ix
+BACKEND_STATUS_t backendHandle(const int ix, char *resp, const int len);
+
+//! process a (verified) status push from the watcher, see wifi.cpp
+void backendHandlePush(char *line);
+
+//! check connection (timeouts) while no data is arriving
+BACKEND_STATUS_t backendCheck(const int ix);
+
+//! connection modes
+typedef enum BACKEND_MODE_e
+{
+    BACKEND_MODE_STREAM,   //!< endless realtime stream
+    BACKEND_MODE_LONGPOLL, //!< one request per change (for proxies that buffer the stream)
+
+} BACKEND_MODE_t;
+
+//! current connection mode
+BACKEND_MODE_t backendGetMode(const int ix);
+
+//! connection mode to use for the next request (call this before building the request)
+BACKEND_MODE_t backendConnectMode(const int ix);
+
+//! last seen long-poll generation (0 = none, request full status)
+uint32_t backendGetPollGen(const int ix);
+
+//! time [ms] of the last heartbeat (0 = none yet)
+uint32_t backendGetLastHeartbeat(const int ix);
+
+//! get (and clear) the pending report to send back to the backend (e.g. the LED profile)
+/*!
+    \param[in]  ix      backend (subscription)
+    \param[out] report  the report (URL-safe characters only)
+    \param[in]  size    size of the report buffer
+
+    \returns true if there was a report
+*/
+bool backendGetReport(const int ix, char *report, const int size);
+
+//! backend did not respond at all (proxy holding back the stream?)
+void backendStalled(const int ix);
+
+//! we didn't service backend ix for dt [ms] (blocked by another connection), extend its timeouts
+void backendPause(const int ix, const uint32_t dt);
+
+//! connection to backend closed, set jenkins state of its channels unknown (keepStatus = true) or clear it
+void backendDisconnect(const int ix, const bool keepStatus);
 
-void backendDisconnect(const bool keepStatus);
+//! reset stream state only (e.g. when switching to a new connection), keeps jenkins state
+void backendReset(const int ix);
 
 #endif // __BACKEND_H__
 //@}
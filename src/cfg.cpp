@@ -16,14 +16,26 @@
 static CFG_MODEL_t  sCfgModel;
 static CFG_DRIVER_t sCfgDriver;
 static CFG_ORDER_t  sCfgOrder;
+static CFG_DRIVER_t sCfgDriver2;
+static CFG_ORDER_t  sCfgOrder2;
 static CFG_BRIGHT_t sCfgBright;
 static CFG_NOISE_t  sCfgNoise;
+static CFG_HUES_t   sCfgHues;
+static CFG_RUNNING_t sCfgRunning;
+static char         sCfgLeds[160];
+static uint32_t     sCfgLedsGen;
 
 CFG_MODEL_t  cfgGetModel(void)  { return sCfgModel; }
 CFG_DRIVER_t cfgGetDriver(void) { return sCfgDriver; }
 CFG_ORDER_t  cfgGetOrder(void)  { return sCfgOrder; }
+CFG_DRIVER_t cfgGetDriver2(void) { return sCfgDriver2; }
+CFG_ORDER_t  cfgGetOrder2(void)  { return sCfgOrder2; }
 CFG_BRIGHT_t cfgGetBright(void) { return sCfgBright; }
 CFG_NOISE_t  cfgGetNoise(void)  { return sCfgNoise; }
+CFG_HUES_t   cfgGetHues(void)   { return sCfgHues; }
+CFG_RUNNING_t cfgGetRunning(void) { return sCfgRunning; }
+const char  *cfgGetLeds(void)   { return sCfgLeds; }
+uint32_t     cfgGetLedsGen(void) { return sCfgLedsGen; }
 
 void cfgSetNoise(CFG_NOISE_t noise)
 {
@@ -58,7 +70,7 @@ static const char *sCfgDriverToStr(const CFG_DRIVER_t driver)
     switch (driver)
     {
         case CFG_DRIVER_WS2801:  return PSTR(CFG_DRIVER_WS2801_STR);
-      //case CFG_DRIVER_WS2812:  return PSTR(CFG_DRIVER_WS2812_STR);
+        case CFG_DRIVER_WS2812:  return PSTR(CFG_DRIVER_WS2812_STR);
         case CFG_DRIVER_SK9822:  return PSTR(CFG_DRIVER_SK9822_STR);
         case CFG_DRIVER_UNKNOWN:
         default:                 return PSTR(CFG_DRIVER_UNKNOWN_STR);
@@ -118,7 +130,7 @@ static CFG_MODEL_t sCfgStrToModel(const char *str)
 static CFG_DRIVER_t sCfgStrToDriver(const char *str)
 {
     if      (strcmp(CFG_DRIVER_WS2801_STR, str) == 0) { return CFG_DRIVER_WS2801; }
-  //else if (strcmp(CFG_DRIVER_WS2812_STR, str) == 0) { return CFG_DRIVER_WS2812; }
+    else if (strcmp(CFG_DRIVER_WS2812_STR, str) == 0) { return CFG_DRIVER_WS2812; }
     else if (strcmp(CFG_DRIVER_SK9822_STR, str) == 0) { return CFG_DRIVER_SK9822; }
     else                                              { return CFG_DRIVER_UNKNOWN; }
 }
@@ -143,6 +155,46 @@ static CFG_BRIGHT_t sCfgStrToBright(const char *str)
     else                                              { return CFG_BRIGHT_UNKNOWN; }
 }
 
+static const char *sCfgHuesToStr(const CFG_HUES_t hues)
+{
+    switch (hues)
+    {
+        case CFG_HUES_CLASSIC:   return PSTR(CFG_HUES_CLASSIC_STR);
+        case CFG_HUES_RAINBOW:   return PSTR(CFG_HUES_RAINBOW_STR);
+        case CFG_HUES_UNKNOWN:
+        default:                 return PSTR(CFG_HUES_UNKNOWN_STR);
+    }
+}
+
+static CFG_HUES_t sCfgStrToHues(const char *str)
+{
+    if      (strcmp(CFG_HUES_CLASSIC_STR, str) == 0) { return CFG_HUES_CLASSIC; }
+    else if (strcmp(CFG_HUES_RAINBOW_STR, str) == 0) { return CFG_HUES_RAINBOW; }
+    else                                             { return CFG_HUES_UNKNOWN; }
+}
+
+static const char *sCfgRunningToStr(const CFG_RUNNING_t running)
+{
+    switch (running)
+    {
+        case CFG_RUNNING_PULSE:  return PSTR(CFG_RUNNING_PULSE_STR);
+        case CFG_RUNNING_ROTATE: return PSTR(CFG_RUNNING_ROTATE_STR);
+        case CFG_RUNNING_CHASE:  return PSTR(CFG_RUNNING_CHASE_STR);
+        case CFG_RUNNING_COMET:  return PSTR(CFG_RUNNING_COMET_STR);
+        case CFG_RUNNING_UNKNOWN:
+        default:                 return PSTR(CFG_RUNNING_UNKNOWN_STR);
+    }
+}
+
+static CFG_RUNNING_t sCfgStrToRunning(const char *str)
+{
+    if      (strcmp(CFG_RUNNING_PULSE_STR,  str) == 0) { return CFG_RUNNING_PULSE; }
+    else if (strcmp(CFG_RUNNING_ROTATE_STR, str) == 0) { return CFG_RUNNING_ROTATE; }
+    else if (strcmp(CFG_RUNNING_CHASE_STR,  str) == 0) { return CFG_RUNNING_CHASE; }
+    else if (strcmp(CFG_RUNNING_COMET_STR,  str) == 0) { return CFG_RUNNING_COMET; }
+    else                                               { return CFG_RUNNING_UNKNOWN; }
+}
+
 static CFG_NOISE_t sCfgStrToNoise(const char *str)
 {
     if      (strcmp(CFG_NOISE_NONE_STR, str) == 0) { return CFG_NOISE_NONE; }
@@ -155,7 +207,7 @@ static CFG_NOISE_t sCfgStrToNoise(const char *str)
 bool cfgApply(const char *json)
 {
     DEBUG("cfg: json=%s", json);
-    StaticJsonDocument<200> doc;
+    StaticJsonDocument<512> doc;
     DeserializationError error = deserializeJson(doc, json);
     if (error)
     {
@@ -167,6 +219,11 @@ bool cfgApply(const char *json)
     const char *strOrder  = doc[F("order")];
     const char *strBright = doc[F("bright")];
     const char *strNoise  = doc[F("noise")];
+    const char *strLeds   = doc[F("leds")];
+    const char *strHues   = doc[F("hues")];
+    const char *strRunning = doc[F("running")];
+    const char *strDriver2 = doc[F("driver2")];
+    const char *strOrder2  = doc[F("order2")];
     CFG_MODEL_t  cfgModel  = strModel  != NULL ? sCfgStrToModel(strModel)   : CFG_MODEL_UNKNOWN;
     CFG_DRIVER_t cfgDriver = strDriver != NULL ? sCfgStrToDriver(strDriver) : CFG_DRIVER_UNKNOWN;
     CFG_ORDER_t  cfgOrder  = strOrder  != NULL ? sCfgStrToOrder(strOrder)   : CFG_ORDER_UNKNOWN;
@@ -189,6 +246,46 @@ bool cfgApply(const char *json)
         sCfgOrder  = cfgOrder;
         sCfgBright = cfgBright;
         sCfgNoise  = cfgNoise;
+        // optional
+        const CFG_HUES_t cfgHues = (strHues != NULL) && (strHues[0] != '\0') ? sCfgStrToHues(strHues) : CFG_HUES_CLASSIC;
+        if (cfgHues != CFG_HUES_UNKNOWN)
+        {
+            sCfgHues = cfgHues;
+        }
+        else
+        {
+            WARNING("cfg: bad hues %s", strHues);
+        }
+        const CFG_RUNNING_t cfgRunning = (strRunning != NULL) && (strRunning[0] != '\0') ? sCfgStrToRunning(strRunning) : CFG_RUNNING_PULSE;
+        if (cfgRunning != CFG_RUNNING_UNKNOWN)
+        {
+            sCfgRunning = cfgRunning;
+        }
+        else
+        {
+            WARNING("cfg: bad running %s", strRunning);
+        }
+        // second LED strip, unless configured differently the same as the first
+        const CFG_DRIVER_t cfgDriver2 = (strDriver2 != NULL) && (strDriver2[0] != '\0') ? sCfgStrToDriver(strDriver2) : CFG_DRIVER_UNKNOWN;
+        const CFG_ORDER_t  cfgOrder2  = (strOrder2  != NULL) && (strOrder2[0]  != '\0') ? sCfgStrToOrder(strOrder2)   : CFG_ORDER_UNKNOWN;
+        sCfgDriver2 = cfgDriver2 != CFG_DRIVER_UNKNOWN ? cfgDriver2 : cfgDriver;
+        sCfgOrder2  = cfgOrder2  != CFG_ORDER_UNKNOWN  ? cfgOrder2  : cfgOrder;
+        if (strLeds == NULL)
+        {
+            strLeds = "";
+        }
+        if (strcmp(sCfgLeds, strLeds) != 0)
+        {
+            if (strlen(strLeds) < sizeof(sCfgLeds))
+            {
+                strcpy(sCfgLeds, strLeds);
+                sCfgLedsGen++;
+            }
+            else
+            {
+                WARNING("cfg: leds too long");
+            }
+        }
         PRINT("cfg: okay");
         return true;
     }
@@ -201,10 +298,11 @@ bool cfgApply(const char *json)
 
 static void sCfgMonStatus(void)
 {
-    DEBUG("mon: cfg: model=%s, driver=%s, order=%s, bright=%s, noise=%s",
+    DEBUG("mon: cfg: model=%s, driver=%s, order=%s, bright=%s, noise=%s, hues=%s, leds=%s, driver2=%s, order2=%s, running=%s",
         sCfgModelToStr(sCfgModel), sCfgDriverToStr(sCfgDriver),
         sCfgOrderToStr(sCfgOrder), sCfgBrightToStr(sCfgBright),
-        sCfgNoiseToStr(sCfgNoise));
+        sCfgNoiseToStr(sCfgNoise), sCfgHuesToStr(sCfgHues), sCfgLeds,
+        sCfgDriverToStr(sCfgDriver2), sCfgOrderToStr(sCfgOrder2), sCfgRunningToStr(sCfgRunning));
 }
 
 void cfgInit(void)
@@ -213,8 +311,12 @@ void cfgInit(void)
     sCfgModel  = CFG_MODEL_UNKNOWN;
     sCfgDriver = CFG_DRIVER_UNKNOWN;
     sCfgOrder  = CFG_ORDER_UNKNOWN;
+    sCfgDriver2 = CFG_DRIVER_UNKNOWN;
+    sCfgOrder2  = CFG_ORDER_UNKNOWN;
     sCfgBright = CFG_BRIGHT_UNKNOWN;
     sCfgNoise  = CFG_NOISE_SOME;
+    sCfgHues   = CFG_HUES_CLASSIC;
+    sCfgRunning = CFG_RUNNING_PULSE;
     debugRegisterMon(sCfgMonStatus);
 }
 
@@ -37,7 +37,7 @@ typedef enum CFG_DRIVER_e
 {
     CFG_DRIVER_UNKNOWN,
     CFG_DRIVER_WS2801,
-  //CFG_DRIVER_WS2812,
+    CFG_DRIVER_WS2812,
     CFG_DRIVER_SK9822,
 } CFG_DRIVER_t;
 
@@ -95,12 +95,56 @@ typedef enum CFG_NOISE_e
 #define CFG_NOISE_MORE_STR       "more"
 #define CFG_NOISE_MOST_STR       "most"
 
+typedef enum CFG_HUES_e
+{
+    CFG_HUES_UNKNOWN,
+    CFG_HUES_CLASSIC,
+    CFG_HUES_RAINBOW,
+} CFG_HUES_t;
+
+#define CFG_HUES_UNKNOWN_STR     "unknown"
+#define CFG_HUES_CLASSIC_STR     "classic"
+#define CFG_HUES_RAINBOW_STR     "rainbow"
+
+typedef enum CFG_RUNNING_e
+{
+    CFG_RUNNING_UNKNOWN,
+    CFG_RUNNING_PULSE,
+    CFG_RUNNING_ROTATE,
+    CFG_RUNNING_CHASE,
+    CFG_RUNNING_COMET,
+} CFG_RUNNING_t;
+
+#define CFG_RUNNING_UNKNOWN_STR  "unknown"
+#define CFG_RUNNING_PULSE_STR    "pulse"
+#define CFG_RUNNING_ROTATE_STR   "rotate"
+#define CFG_RUNNING_CHASE_STR    "chase"
+#define CFG_RUNNING_COMET_STR    "comet"
+
 CFG_MODEL_t  cfgGetModel(void);
 CFG_DRIVER_t cfgGetDriver(void);
 CFG_ORDER_t  cfgGetOrder(void);
 CFG_BRIGHT_t cfgGetBright(void);
 CFG_NOISE_t  cfgGetNoise(void);
 
+//! driver of the second LED strip (see #LEDS_NUM_STRIPS), the same as the first unless configured otherwise
+CFG_DRIVER_t cfgGetDriver2(void);
+
+//! colour order of the second LED strip, the same as the first unless configured otherwise
+CFG_ORDER_t  cfgGetOrder2(void);
+
+//! hue to colour mapping, "classic" unless configured otherwise
+CFG_HUES_t   cfgGetHues(void);
+
+//! effect for running jobs, "pulse" unless configured otherwise
+CFG_RUNNING_t cfgGetRunning(void);
+
+//! channel to LEDs map (see ledsSetState()), "" = one LED per channel
+const char  *cfgGetLeds(void);
+
+//! changes whenever the channel to LEDs map changes
+uint32_t     cfgGetLedsGen(void);
+
 void cfgSetNoise(CFG_NOISE_t noise);
 
 bool cfgApply(const char *json);
@@ -5,7 +5,8 @@
     - Copyright (c) 2017-2020 Philippe Kehl (flipflip at oinkzwurgl dot org),
       https://oinkzwurgl.org/projaeggd/tschenggins-laempli
 
-    \todo https://github.com/FastLED/FastLED/wiki/Pixel-reference --> "rainbow"
+    - Credits: "rainbow" hue mapping inspired by FastLED's hsv2rgb_rainbow()
+      (https://github.com/FastLED/FastLED/wiki/Pixel-reference)
 
     \addtogroup FF_HSV2RGB
 
@@ -15,12 +16,42 @@
 #include "hsv2rgb.h"
 
 
-#define HSV2RGB_METHOD 2
+#define HSV2RGB_METHOD 3
+
+// Saturation/Value lookup table to compensate for the nonlinearity of human
+// vision. Used in the getRGB function on saturation and brightness to make
+// dimming look more natural. Exponential function used to create values below
+// : x from 0 - 255 : y = round(pow( 2.0, x+64/40.0) - 1)
+// From: http://www.kasperkamperman.com/blog/arduino/arduino-programming-hsb-to-rgb/
+static const uint8_t skMatrixDimCurve[] = // RAM
+{
+      0,   1,   1,   2,   2,   2,   2,   2,   2,   3,   3,   3,   3,   3,   3,   3,
+      3,   3,   3,   3,   3,   3,   3,   4,   4,   4,   4,   4,   4,   4,   4,   4,
+      4,   4,   4,   5,   5,   5,   5,   5,   5,   5,   5,   5,   5,   6,   6,   6,
+      6,   6,   6,   6,   6,   7,   7,   7,   7,   7,   7,   7,   8,   8,   8,   8,
+      8,   8,   9,   9,   9,   9,   9,   9,  10,  10,  10,  10,  10,  11,  11,  11,
+     11,  11,  12,  12,  12,  12,  12,  13,  13,  13,  13,  14,  14,  14,  14,  15,
+     15,  15,  16,  16,  16,  16,  17,  17,  17,  18,  18,  18,  19,  19,  19,  20,
+     20,  20,  21,  21,  22,  22,  22,  23,  23,  24,  24,  25,  25,  25,  26,  26,
+     27,  27,  28,  28,  29,  29,  30,  30,  31,  32,  32,  33,  33,  34,  35,  35,
+     36,  36,  37,  38,  38,  39,  40,  40,  41,  42,  43,  43,  44,  45,  46,  47,
+     48,  48,  49,  50,  51,  52,  53,  54,  55,  56,  57,  58,  59,  60,  61,  62,
+     63,  64,  65,  66,  68,  69,  70,  71,  73,  74,  75,  76,  78,  79,  81,  82,
+     83,  85,  86,  88,  90,  91,  93,  94,  96,  98,  99, 101, 103, 105, 107, 109,
+    110, 112, 114, 116, 118, 121, 123, 125, 127, 129, 132, 134, 136, 139, 141, 144,
+    146, 149, 151, 154, 157, 159, 162, 165, 168, 171, 174, 177, 180, 183, 186, 190,
+    193, 196, 200, 203, 207, 211, 214, 218, 222, 226, 230, 234, 238, 242, 248, 255
+};
+
+uint8_t hsv2rgbDim(const uint8_t val)
+{
+    return skMatrixDimCurve[val];
+}
 
 /* ***** HSV to RGB conversion ******************************************************************* */
 
-#if ( (HSV2RGB_METHOD == 1) || (HSV2RGB_METHOD == 2) )
-// classic HSV2RGB code (#HSV2RGB_METHOD 1 and 2) à la Wikipedia
+#if ( (HSV2RGB_METHOD == 1) || (HSV2RGB_METHOD == 2) || (HSV2RGB_METHOD == 3) )
+// classic HSV2RGB code (#HSV2RGB_METHOD 1, 2 and 3) à la Wikipedia
 #  define HSV2RGB_CLASSIC(_H, _S, _V, _R, _G, _B) \
     const uint8_t __H = _H; \
     const uint8_t __S = _S; \
@@ -52,32 +83,6 @@ void hsv2rgb(const uint8_t H, const uint8_t S, uint8_t V, uint8_t *R, uint8_t *G
 // ***** saturation/value dimming *****
 #elif (HSV2RGB_METHOD == 2)
 
-// saturation/value lookup table
-// Saturation/Value lookup table to compensate for the nonlinearity of human
-// vision. Used in the getRGB function on saturation and brightness to make
-// dimming look more natural. Exponential function used to create values below
-// : x from 0 - 255 : y = round(pow( 2.0, x+64/40.0) - 1)
-// From: http://www.kasperkamperman.com/blog/arduino/arduino-programming-hsb-to-rgb/
-static const uint8_t skMatrixDimCurve[] = // RAM
-{
-      0,   1,   1,   2,   2,   2,   2,   2,   2,   3,   3,   3,   3,   3,   3,   3,
-      3,   3,   3,   3,   3,   3,   3,   4,   4,   4,   4,   4,   4,   4,   4,   4,
-      4,   4,   4,   5,   5,   5,   5,   5,   5,   5,   5,   5,   5,   6,   6,   6,
-      6,   6,   6,   6,   6,   7,   7,   7,   7,   7,   7,   7,   8,   8,   8,   8,
-      8,   8,   9,   9,   9,   9,   9,   9,  10,  10,  10,  10,  10,  11,  11,  11,
-     11,  11,  12,  12,  12,  12,  12,  13,  13,  13,  13,  14,  14,  14,  14,  15,
-     15,  15,  16,  16,  16,  16,  17,  17,  17,  18,  18,  18,  19,  19,  19,  20,
-     20,  20,  21,  21,  22,  22,  22,  23,  23,  24,  24,  25,  25,  25,  26,  26,
-     27,  27,  28,  28,  29,  29,  30,  30,  31,  32,  32,  33,  33,  34,  35,  35,
-     36,  36,  37,  38,  38,  39,  40,  40,  41,  42,  43,  43,  44,  45,  46,  47,
-     48,  48,  49,  50,  51,  52,  53,  54,  55,  56,  57,  58,  59,  60,  61,  62,
-     63,  64,  65,  66,  68,  69,  70,  71,  73,  74,  75,  76,  78,  79,  81,  82,
-     83,  85,  86,  88,  90,  91,  93,  94,  96,  98,  99, 101, 103, 105, 107, 109,
-    110, 112, 114, 116, 118, 121, 123, 125, 127, 129, 132, 134, 136, 139, 141, 144,
-    146, 149, 151, 154, 157, 159, 162, 165, 168, 171, 174, 177, 180, 183, 186, 190,
-    193, 196, 200, 203, 207, 211, 214, 218, 222, 226, 230, 234, 238, 242, 248, 255
-};
-
 
 void hsv2rgb(const uint8_t H, const uint8_t S, uint8_t V, uint8_t *R, uint8_t *G, uint8_t *B)
 {
@@ -86,10 +91,116 @@ void hsv2rgb(const uint8_t H, const uint8_t S, uint8_t V, uint8_t *R, uint8_t *G
 }
 
 
+// ***** saturation dimming only, value dimming is left to the caller (see hsv2rgbDim()) *****
+#elif (HSV2RGB_METHOD == 3)
+
+void hsv2rgb(const uint8_t H, const uint8_t S, uint8_t V, uint8_t *R, uint8_t *G, uint8_t *B)
+{
+    HSV2RGB_CLASSIC(H, 255 - skMatrixDimCurve[255 - S], V,
+        *R, *G, *B);
+}
+
 #else
 #  error Illegal value for HSV2RGB_METHOD!
 #endif
 
+// saturation as used by the conversion
+#if (HSV2RGB_METHOD == 1)
+#  define HSV2RGB_SAT(_S) (_S)
+#else
+#  define HSV2RGB_SAT(_S) (255 - skMatrixDimCurve[255 - (_S)])
+#endif
+
+/* ***** HSV to RGB conversion, many colours at once ********************************************** */
+
+// Classic: The R, G and B values are each one of four levels, V, l, l + r and V - r (see
+// HSV2RGB_CLASSIC()). These are packed into one word and the table gives the position (shift) of the
+// level to use for R, G and B in each of the six segments.
+static const uint8_t skHsv2rgbClassicShift[6][3] =
+{
+    {  0, 16,  8 }, // V,     l + r, l
+    { 24,  0,  8 }, // V - r, V,     l
+    {  8,  0, 16 }, // l,     V,     l + r
+    {  8, 24,  0 }, // l,     V - r, V
+    { 16,  8,  0 }, // l + r, l,     V
+    {  0,  8, 24 }, // V,     l,     V - r
+};
+
+static void sHsv2rgbManyClassic(const uint8_t *pkH, const uint8_t *pkS, const uint8_t *pkV, uint8_t *pRGB, const int num)
+{
+    for (int ix = 0; ix < num; ix++)
+    {
+        const uint32_t H = pkH[ix];
+        const uint32_t S = HSV2RGB_SAT(pkS[ix]);
+        const uint32_t V = pkV[ix];
+        const uint32_t s = (6 * H) >> 8;
+        const uint32_t t = (6 * H) & 0xff;
+        const uint32_t l = (V * (255 - S)) >> 8;
+        const uint32_t r = (V * S * t) >> 16;
+        const uint32_t levels = V | (l << 8) | ((l + r) << 16) | ((V - r) << 24);
+        const uint8_t *pkShift = skHsv2rgbClassicShift[s];
+        pRGB[0] = levels >> pkShift[0];
+        pRGB[1] = levels >> pkShift[1];
+        pRGB[2] = levels >> pkShift[2];
+        pRGB += 3;
+    }
+}
+
+// Rainbow: Eight sections of 32 hues. In each the R, G and B values start at some level and go up or
+// down by a third or two thirds of the way towards the next section.
+static const int16_t skHsv2rgbRainbow[8][3][2] = // { start, thirds }
+{
+    { { 255, -1 }, {   0,  1 }, {   0,  0 } }, // red    -> orange
+    { { 171,  0 }, {  85,  1 }, {   0,  0 } }, // orange -> yellow
+    { { 171, -2 }, { 170,  1 }, {   0,  0 } }, // yellow -> green
+    { {   0,  0 }, { 255, -1 }, {   0,  1 } }, // green  -> aqua
+    { {   0,  0 }, { 171, -2 }, {  85,  2 } }, // aqua   -> blue
+    { {   0,  1 }, {   0,  0 }, { 255, -1 } }, // blue   -> purple
+    { {  85,  1 }, {   0,  0 }, { 171, -1 } }, // purple -> pink
+    { { 170,  1 }, {   0,  0 }, {  85, -1 } }, // pink   -> red
+};
+
+static void sHsv2rgbManyRainbow(const uint8_t *pkH, const uint8_t *pkS, const uint8_t *pkV, uint8_t *pRGB, const int num)
+{
+    for (int ix = 0; ix < num; ix++)
+    {
+        const uint32_t H = pkH[ix];
+        const uint32_t S = HSV2RGB_SAT(pkS[ix]);
+        const uint32_t V = pkV[ix];
+        const int16_t (*pkSect)[2] = skHsv2rgbRainbow[H >> 5];
+        const int32_t third = ((H & 0x1f) << 3) * 85 >> 8;
+        const uint32_t R = pkSect[0][0] + (pkSect[0][1] * third);
+        const uint32_t G = pkSect[1][0] + (pkSect[1][1] * third);
+        const uint32_t B = pkSect[2][0] + (pkSect[2][1] * third);
+        // saturation and value, R and B in one go (SWAR, two 16 bit lanes)
+        const uint32_t desat = 255 - S;
+        uint32_t rb = (R | (B << 16));
+        uint32_t g  = G;
+        rb = (((rb * (S + 1)) >> 8) & 0x00ff00ff) + (desat | (desat << 16));
+        g  =  ((g  * (S + 1)) >> 8)               +  desat;
+        rb = ((rb * (V + 1)) >> 8) & 0x00ff00ff;
+        g  =  (g  * (V + 1)) >> 8;
+        pRGB[0] = rb;
+        pRGB[1] = g;
+        pRGB[2] = rb >> 16;
+        pRGB += 3;
+    }
+}
+
+void hsv2rgbMany(const uint8_t *pkH, const uint8_t *pkS, const uint8_t *pkV, uint8_t *pRGB, const int num,
+    const HSV2RGB_MODE_t mode)
+{
+    switch (mode)
+    {
+        case HSV2RGB_MODE_CLASSIC:
+            sHsv2rgbManyClassic(pkH, pkS, pkV, pRGB, num);
+            break;
+        case HSV2RGB_MODE_RAINBOW:
+            sHsv2rgbManyRainbow(pkH, pkS, pkV, pRGB, num);
+            break;
+    }
+}
+
 
 
 /* *********************************************************************************************** */
@@ -33,6 +33,38 @@ extern "C" {
 */
 void hsv2rgb(const uint8_t H, const uint8_t S, uint8_t V, uint8_t *R, uint8_t *G, uint8_t *B);
 
+//! dim curve to compensate for the nonlinearity of human vision
+/*!
+    hsv2rgb() applies this to the saturation only. Apply it to the resulting R, G and B values to get
+    natural looking dimming (see the LEDs output lookup table).
+
+    \param[in] val  linear value (0..255)
+    \returns the dimmed value (0..255)
+*/
+uint8_t hsv2rgbDim(const uint8_t val);
+
+//! hue to colour mapping
+typedef enum HSV2RGB_MODE_e
+{
+    HSV2RGB_MODE_CLASSIC, //!< six equal sections red - yellow - green - cyan - blue - magenta (same as hsv2rgb())
+    HSV2RGB_MODE_RAINBOW, //!< eight sections with more yellow and orange and less cyan, à la FastLED's "rainbow"
+} HSV2RGB_MODE_t;
+
+//! HSV to RGB conversion of many colours at once
+/*!
+    Same as hsv2rgb() for #HSV2RGB_MODE_CLASSIC, but without branches per colour and faster for more than a
+    few colours.
+
+    \param[in]  pkH   hue values (scaled 0..255)
+    \param[in]  pkS   saturation values (scaled 0..255)
+    \param[in]  pkV   "brightness" values (scaled 0..255)
+    \param[out] pRGB  red, green, blue values (0..255), three per colour
+    \param[in]  num   number of colours
+    \param[in]  mode  hue mapping
+*/
+void hsv2rgbMany(const uint8_t *pkH, const uint8_t *pkS, const uint8_t *pkV, uint8_t *pRGB, const int num,
+    const HSV2RGB_MODE_t mode);
+
 
 #ifdef __cplusplus
 }
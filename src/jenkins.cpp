@@ -138,6 +138,24 @@ static const LEDS_PARAM_t *sJenkinsLedStateFromJenkins(const JENKINS_STATE_t sta
                     break;
                 }
             }
+            // other effect for running jobs (along the channel's LEDs, see ledsSetState())
+            LEDS_FX_t fx = LEDS_FX_PULSE;
+            switch (cfgGetRunning())
+            {
+                case CFG_RUNNING_ROTATE: fx = LEDS_FX_ROTATE; break;
+                case CFG_RUNNING_CHASE:  fx = LEDS_FX_CHASE;  break;
+                case CFG_RUNNING_COMET:  fx = LEDS_FX_COMET;  break;
+                case CFG_RUNNING_PULSE:
+                case CFG_RUNNING_UNKNOWN:
+                    break;
+            }
+            if (fx != pRes->fx)
+            {
+                static LEDS_PARAM_t sLedState;
+                sLedState = *pRes;
+                sLedState.fx = fx;
+                pRes = &sLedState;
+            }
             break;
         }
         case JENKINS_STATE_IDLE:
@@ -264,20 +282,65 @@ void jenkinsSetInfo(const JENKINS_INFO_t *pkInfo, bool update)
 // clear all info
 void jenkinsClearAll(void)
 {
-    PRINT("jenkins: clear all");
-    memset(&sJenkinsInfo, 0, sizeof(sJenkinsInfo));
-    for (int ix = 0; ix < NUMOF(sJenkinsInfo); ix++)
+    jenkinsClearRange(0, NUMOF(sJenkinsInfo));
+}
+
+// clear info of a range of channels
+void jenkinsClearRange(const int first, const int num)
+{
+    PRINT("jenkins: clear %d-%d", first, first + num - 1);
+    for (int ix = first; (ix < (first + num)) && (ix < NUMOF(sJenkinsInfo)); ix++)
     {
+        memset(&sJenkinsInfo[ix], 0, sizeof(sJenkinsInfo[ix]));
+        sJenkinsInfo[ix].chIx = ix;
         sJenkinsInfoDirty[ix] = true;
     }
     jenkinsUpdate();
 }
 
+// update state and result of all channels showing the job
+int jenkinsPushInfo(const JENKINS_INFO_t *pkInfo)
+{
+    int numUpdate = 0;
+    for (int ix = 0; ix < NUMOF(sJenkinsInfo); ix++)
+    {
+        JENKINS_INFO_t *pInfo = &sJenkinsInfo[ix];
+        if ( !pInfo->active || (strcmp(pInfo->job, pkInfo->job) != 0) || (strcmp(pInfo->server, pkInfo->server) != 0) )
+        {
+            continue;
+        }
+        // older than what we have, or duplicate
+        if ( (pkInfo->time < pInfo->time) ||
+             ( (pkInfo->time == pInfo->time) && (pkInfo->state == pInfo->state) && (pkInfo->result == pInfo->result) ) )
+        {
+            continue;
+        }
+        pInfo->state  = pkInfo->state;
+        pInfo->result = pkInfo->result;
+        pInfo->time   = pkInfo->time;
+        sJenkinsInfoDirty[ix] = true;
+        PRINT("jenkins: push: #%02d %s %s %s", ix, pInfo->job,
+            sJenkinsStateToStr(pInfo->state), sJenkinsResultToStr(pInfo->result));
+        numUpdate++;
+    }
+    if (numUpdate > 0)
+    {
+        jenkinsUpdate();
+    }
+    return numUpdate;
+}
+
 // set all channels to state unknown
 void jenkinsStateUnknownAll(void)
 {
-    PRINT("jenkins: state unknown all");
-    for (int ix = 0; ix < NUMOF(sJenkinsInfo); ix++)
+    jenkinsStateUnknownRange(0, NUMOF(sJenkinsInfo));
+}
+
+// set a range of channels to state unknown
+void jenkinsStateUnknownRange(const int first, const int num)
+{
+    PRINT("jenkins: state unknown %d-%d", first, first + num - 1);
+    for (int ix = first; (ix < (first + num)) && (ix < NUMOF(sJenkinsInfo)); ix++)
     {
         if (sJenkinsInfo[ix].active)
         {
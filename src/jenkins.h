@@ -91,12 +91,25 @@ void jenkinsSetInfo(const JENKINS_INFO_t *pkInfo, bool update = true);
 
 void jenkinsUpdate(void);
 
+//! update state, result and time of all channels that show a job (from a push by the watcher)
+/*!
+    \param[in] pkInfo  job, server, state, result and time to update
+    \returns the number of channels updated, i.e. channels showing that job and having older info
+*/
+int jenkinsPushInfo(const JENKINS_INFO_t *pkInfo);
+
 //! set all states to JENKINS_STATE_UNKNOWN
 void jenkinsStateUnknownAll(void);
 
+//! set states of channels first..(first+num-1) to JENKINS_STATE_UNKNOWN
+void jenkinsStateUnknownRange(const int first, const int num);
+
 //! clear all info
 void jenkinsClearAll(void);
 
+//! clear info of channels first..(first+num-1)
+void jenkinsClearRange(const int first, const int num);
+
 #endif // __JENKINS_H__
 //@}
 // eof
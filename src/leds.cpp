@@ -1,6 +1,6 @@
 /*!
     \file
-    \brief flipflip's Tschenggins Lämpli: LEDS WS2801 and SK9822 LED driver (see \ref FF_LEDS)
+    \brief flipflip's Tschenggins Lämpli: LEDS WS2801, WS2812 and SK9822 LED driver (see \ref FF_LEDS)
 
     - Copyright (c) 2017-2020 Philippe Kehl (flipflip at oinkzwurgl dot org),
       https://oinkzwurgl.org/projaeggd/tschenggins-laempli
@@ -14,11 +14,27 @@
     - GPIO 13 (D7) = MOSI
     - GPIO 14 (D5) = SCK
 
+    On the ESP8266 the HSPI FIFO is refilled from its interrupt, on the ESP32 the VSPI peripheral sends the
+    frames using DMA. In both cases the next frame is rendered while the previous one is being sent (see
+    #CONFIG_LEDS_SPI_ASYNC).
+
+    WS2812 LEDs are driven by the I2S peripheral using DMA on the ESP8266 (on GPIO 3 (RX), the only
+    pin possible) and by the RMT peripheral on the ESP32 (on #CONFIG_LEDS_WS2812_PIN, by default the
+    same as the MOSI), so that their strict timing doesn't need the CPU.
+
     @{
 */
 
 #include <SPI.h>
 #include <Ticker.h>
+#if defined(ESP8266)
+#  include <i2s_reg.h>
+#elif defined(ESP32)
+#  include <driver/spi_master.h>
+#  include <driver/rmt.h>
+#  include <rom/gpio.h>
+#  include <soc/gpio_sig_map.h>
+#endif
 
 #include "stuff.h"
 #include "debug.h"
@@ -27,12 +43,30 @@
 
 #include "leds.h"
 
-#if LEDS_FPS != 100
-#  error LEDS_FPS != 100 is (probably) not implemented
+// the effects run on the elapsed time, not on the number of ticks, so any rate works as long as the ticker can do it
+#if (LEDS_FPS < 10) || (LEDS_FPS > 200) || ((1000 % LEDS_FPS) != 0)
+#  error LEDS_FPS must be 10..200 and divide 1000 (the ticker runs in [ms])
+#endif
+
+#if (defined(ESP8266) && (LEDS_NUM > 150))
+#  error LEDS_NUM > 150 (or so) is not going to work on the ESP8266.
+#elif (LEDS_NUM > (300 * LEDS_NUM_STRIPS))
+#  error LEDS_NUM > 300 (or so) per strip is not going to work at LEDS_FPS.
+#endif
+
+#if defined(ESP8266) && (LEDS_NUM_STRIPS != 1)
+#  error LEDS_NUM_STRIPS must be 1 on the ESP8266
+#elif (LEDS_NUM_STRIPS < 1) || (LEDS_NUM_STRIPS > 2)
+#  error LEDS_NUM_STRIPS must be 1 or 2
+#elif (LEDS_NUM_STRIPS > 1) && ((CONFIG_LEDS_STRIP0_NUM < 1) || (CONFIG_LEDS_STRIP0_NUM >= LEDS_NUM))
+#  error CONFIG_LEDS_STRIP0_NUM must leave some LEDs for each strip
 #endif
 
-#if (defined(ESP8266) && (LEDS_NUM > 20))
-#  error LEDS_NUM > 20 (or so) is not going to work on the ESP8266.
+// length of the longest strip
+#if (LEDS_NUM_STRIPS > 1)
+#  define LEDS_STRIP_MAX MAX(CONFIG_LEDS_STRIP0_NUM, LEDS_NUM - CONFIG_LEDS_STRIP0_NUM)
+#else
+#  define LEDS_STRIP_MAX LEDS_NUM
 #endif
 
 /* *********************************************************************************************** */
@@ -40,6 +74,18 @@
 // LED frame buffer
 static uint8_t sLedsData[LEDS_NUM][3];
 
+// temporal dithering: carry the fraction the output can't show over to the next frame, so that dim
+// LEDs get more than the handful of levels that are left after applying the brightness, 0 = round
+#ifndef CONFIG_LEDS_DITHER
+#  define CONFIG_LEDS_DITHER 1
+#endif
+
+#if (CONFIG_LEDS_DITHER > 0)
+// LED changed since it was packed last, only those are dithered, the others get the rounded value (so that
+// a still LED doesn't toggle between two levels on each refresh, and an unchanged frame stays unchanged)
+static bool sLedsDitherOn[LEDS_NUM];
+#endif
+
 static void sLedsClear(void)
 {
     memset(&sLedsData, 0, sizeof(sLedsData));
@@ -51,83 +97,191 @@ static void sLedsSetRGB(const uint16_t ix, const uint8_t R, const uint8_t G, con
 {
     if (ix < LEDS_NUM)
     {
-        switch (cfgGetOrder())
+        // the packers (see below) take care of the colour order of the LED strip
+#if (CONFIG_LEDS_DITHER > 0)
+        if ( (sLedsData[ix][_R_] != R) || (sLedsData[ix][_G_] != G) || (sLedsData[ix][_B_] != B) )
         {
-            case CFG_ORDER_RGB: sLedsData[ix][0] = R; sLedsData[ix][1] = G; sLedsData[ix][2] = B; break;
-            case CFG_ORDER_RBG: sLedsData[ix][0] = R; sLedsData[ix][1] = B; sLedsData[ix][2] = G; break;
-            case CFG_ORDER_GRB: sLedsData[ix][0] = G; sLedsData[ix][1] = R; sLedsData[ix][2] = B; break;
-            case CFG_ORDER_GBR: sLedsData[ix][0] = G; sLedsData[ix][1] = B; sLedsData[ix][2] = R; break;
-            case CFG_ORDER_BRG: sLedsData[ix][0] = B; sLedsData[ix][1] = R; sLedsData[ix][2] = G; break;
-            case CFG_ORDER_BGR: sLedsData[ix][0] = B; sLedsData[ix][1] = G; sLedsData[ix][2] = R; break;
-            case CFG_ORDER_UNKNOWN:
-            {
-                const uint8_t RGB = ((uint16_t)R + (uint16_t)G + (uint16_t)B) / 3;
-                sLedsData[ix][0] = RGB; sLedsData[ix][1] = RGB; sLedsData[ix][2] = RGB;
-                break;
-            }
+            sLedsDitherOn[ix] = true;
         }
+#endif
+        sLedsData[ix][_R_] = R;
+        sLedsData[ix][_G_] = G;
+        sLedsData[ix][_B_] = B;
     }
 }
 
-static void sLedsSetHSV(const uint16_t ix, const uint8_t H, const uint8_t S, const uint8_t V)
+// first LED of a strip
+static inline uint16_t sLedsStripIx0(const int stripIx)
 {
-    if (ix < LEDS_NUM)
-    {
-        uint8_t R, G, B;
-        hsv2rgb(H, S, V, &R, &G, &B);
-        sLedsSetRGB(ix, R, G, B);
-    }
+    return stripIx == 0 ? 0 : CONFIG_LEDS_STRIP0_NUM;
+}
+
+// number of LEDs on a strip
+static inline uint16_t sLedsStripNum(const int stripIx)
+{
+    return LEDS_NUM_STRIPS == 1 ? LEDS_NUM : (stripIx == 0 ? CONFIG_LEDS_STRIP0_NUM : LEDS_NUM - CONFIG_LEDS_STRIP0_NUM);
 }
 
-#define LEDS_WS2801_BUFSIZE sizeof(sLedsData)
+/* *********************************************************************************************** */
+
+// The packers convert the frame buffer to the data for the LED strip. There is one for each combination
+// of driver and colour order, generated from the templates below. The right one is selected on config
+// change (see sLedsPackSelect()), so that no decisions have to be made for every pixel of every frame.
+// With more than one strip each strip has its own packer for its part of the frame buffer.
+
+//! packer function for strip stripIx, numLeds LEDs starting at ledIx0, returns the number of bytes to send
+typedef int (*LEDS_PACK_FUNC_t)(uint8_t *outBuf, const int bufSize, const int stripIx, const uint16_t ledIx0, const uint16_t numLeds);
+
+// current packer for each strip (NULL = don't know how to talk to the LED strip)
+static LEDS_PACK_FUNC_t sLedsPackFunc[LEDS_NUM_STRIPS];
+
+// current packer is for the WS2812 output (true) or for the SPI (false)
+static bool sLedsPackWs2812[LEDS_NUM_STRIPS];
+
+// optional gamma correction (x10, e.g. 22 for 2.2) instead of the hsv2rgbDim() curve, 0 = use the latter
+#ifndef CONFIG_LEDS_GAMMA_X10
+#  define CONFIG_LEDS_GAMMA_X10 0
+#endif
+
+// output lookup table for each strip: dim curve (or gamma) and global brightness in one, 8.8 fixed point
+static uint16_t sLedsOutLut[LEDS_NUM_STRIPS][256];
+static uint32_t sLedsOutLutScale[LEDS_NUM_STRIPS]; // brightness the table is for, 0 = none yet
 
-static int sLedsRenderWS2801(uint8_t *outBuf, const int bufSize)
+// SK9822 global brightness (0..31) for each strip, see sLedsOutLutBuild()
+static uint8_t sLedsSk9822Bright[LEDS_NUM_STRIPS];
+
+#if (CONFIG_LEDS_DITHER > 0)
+// fraction left over from the previous frame for each LED and component (in the output order)
+static uint8_t sLedsDither[LEDS_NUM][3];
+#endif
+
+static void sLedsOutLutBuild(const int stripIx, const CFG_DRIVER_t driver, const CFG_BRIGHT_t bright)
 {
-    memset(outBuf, 0, bufSize);
-    const int outSize = MIN(bufSize, sizeof(sLedsData));
     uint32_t brightness = 0;
-    switch (cfgGetBright())
+    switch (bright)
     {
-        case CFG_BRIGHT_FULL:   brightness =   0; break;
+        case CFG_BRIGHT_FULL:   brightness = 256; break;
         case CFG_BRIGHT_HIGH:   brightness = 200; break;
         case CFG_BRIGHT_MEDIUM: brightness = 100; break;
         case CFG_BRIGHT_UNKNOWN:
         case CFG_BRIGHT_LOW:    brightness =  50; break;
     }
-    if (brightness == 0)
+
+    // the SK9822 does the coarse step with its 5 bit global brightness (it reduces the current), and the
+    // table only the rest, so that dim LEDs still get (almost) the full 8 bits
+    uint32_t scale = brightness;
+    if (driver == CFG_DRIVER_SK9822)
+    {
+        const uint32_t global = ((brightness * 31) + 255) / 256; // round up, the table can only dim
+        sLedsSk9822Bright[stripIx] = global;
+        scale = (brightness * 31) / global;
+    }
+
+    if (scale == sLedsOutLutScale[stripIx])
     {
-        memcpy(outBuf, sLedsData, outSize);
+        return;
     }
-    else
+    sLedsOutLutScale[stripIx] = scale;
+
+    uint16_t *pLut = sLedsOutLut[stripIx];
+    for (int ix = 0; ix < NUMOF(sLedsOutLut[stripIx]); ix++)
     {
-        const uint32_t thrs = 256 / brightness;
-        const uint8_t *inBuf = (const uint8_t *)sLedsData;
-        for (uint32_t ix = 0; ix < bufSize; ix++)
+#if (CONFIG_LEDS_GAMMA_X10 > 0)
+        uint32_t val = (uint32_t)( (powf((float)ix / 255.0f, (float)CONFIG_LEDS_GAMMA_X10 / 10.0f) * 255.0f * 256.0f) + 0.5f );
+#else
+        uint32_t val = (uint32_t)hsv2rgbDim(ix) << 8;
+#endif
+        val = (val * scale) >> 8;
+        // max. 255.0 so that the fraction carried over can't overflow the output
+        if (val > 0xff00)
+        {
+            val = 0xff00;
+        }
+        // don't switch off LEDs that should be on, however dim
+        if ( (ix != 0) && (val < 0x0100) )
         {
-            const uint32_t in = inBuf[ix];
-            if (in != 0) { outBuf[ix] = (in <= thrs) ? 1 : ((in * brightness) >> 8); } else { outBuf[ix] = in; }
+            val = 0x0100;
         }
+        pLut[ix] = val;
+    }
+#if (CONFIG_LEDS_DITHER > 0)
+    memset(&sLedsDither[sLedsStripIx0(stripIx)], 0, sLedsStripNum(stripIx) * sizeof(sLedsDither[0]));
+#endif
+    DEBUG("leds: lut %d (bright=%u, scale=%u, gamma=%d, dither=%d): 0x%04x 0x%04x 0x%04x .. 0x%04x 0x%04x 0x%04x",
+        stripIx, brightness, scale, CONFIG_LEDS_GAMMA_X10, CONFIG_LEDS_DITHER,
+        pLut[0], pLut[1], pLut[2], pLut[127], pLut[128], pLut[255]);
+}
+
+// output value for one component of one LED, dithered or rounded
+static inline uint8_t sLedsOutVal(const uint16_t *pkLut, const uint8_t in, const uint16_t ledIx, const int c, const bool dither)
+{
+#if (CONFIG_LEDS_DITHER > 0)
+    if (dither)
+    {
+        const uint16_t val = pkLut[in] + sLedsDither[ledIx][c];
+        sLedsDither[ledIx][c] = val & 0xff;
+        return val >> 8;
     }
-    return outSize;
+    sLedsDither[ledIx][c] = 0;
+#else
+    (void)ledIx;
+    (void)c;
+    (void)dither;
+#endif
+    return (pkLut[in] + 0x80) >> 8;
 }
 
-#define LEDS_SK9822_END_BYTES ( LEDS_NUM / 2 / 8 + 1 )
-#define LEDS_SK9822_BUFSIZE ( 4 + (LEDS_NUM * 4) + 4 + LEDS_SK9822_END_BYTES )
+// unknown colour order, use grey (also used as O0 template argument)
+#define LEDS_ORDER_GREY -1
 
-static int sLedsRenderSK9822(uint8_t *outBuf, const int bufSize)
+// pack one pixel (LED ledIx) into the output order O0, O1, O2 (_R_, _G_, _B_), using the strip's lookup table
+template<int O0, int O1, int O2>
+static inline void sLedsPackPixel(uint8_t *pOut, const uint16_t *pkLut, const uint16_t ledIx)
 {
-    memset(outBuf, 0, bufSize);
+    const uint8_t *pkIn = sLedsData[ledIx];
+#if (CONFIG_LEDS_DITHER > 0)
+    const bool dither = sLedsDitherOn[ledIx];
+    sLedsDitherOn[ledIx] = false;
+#else
+    const bool dither = false;
+#endif
+    if (O0 == LEDS_ORDER_GREY)
+    {
+        const uint8_t RGB = ((uint16_t)pkIn[_R_] + (uint16_t)pkIn[_G_] + (uint16_t)pkIn[_B_]) / 3;
+        pOut[0] = sLedsOutVal(pkLut, RGB, ledIx, 0, dither);
+        pOut[1] = sLedsOutVal(pkLut, RGB, ledIx, 1, dither);
+        pOut[2] = sLedsOutVal(pkLut, RGB, ledIx, 2, dither);
+    }
+    else
+    {
+        pOut[0] = sLedsOutVal(pkLut, pkIn[O0], ledIx, 0, dither);
+        pOut[1] = sLedsOutVal(pkLut, pkIn[O1], ledIx, 1, dither);
+        pOut[2] = sLedsOutVal(pkLut, pkIn[O2], ledIx, 2, dither);
+    }
+}
+
+#define LEDS_WS2801_BUFSIZE ( LEDS_STRIP_MAX * 3 )
 
-    uint8_t brightness = 0;
-    switch (cfgGetBright())
+template<int O0, int O1, int O2>
+static int sLedsPackWS2801(uint8_t *outBuf, const int bufSize, const int stripIx, const uint16_t ledIx0, const uint16_t numLeds)
+{
+    const uint16_t *pkLut = sLedsOutLut[stripIx];
+    const int num = MIN(numLeds, bufSize / 3);
+    uint8_t *pOut = outBuf;
+    for (int ix = 0; ix < num; ix++)
     {
-        case CFG_BRIGHT_FULL:   brightness = 31; break;
-        case CFG_BRIGHT_HIGH:   brightness = 20; break;
-        case CFG_BRIGHT_MEDIUM: brightness = 10; break;
-        case CFG_BRIGHT_UNKNOWN:
-        case CFG_BRIGHT_LOW:    brightness =  5; break;
+        sLedsPackPixel<O0, O1, O2>(pOut, pkLut, ledIx0 + ix);
+        pOut += 3;
     }
+    return num * 3;
+}
+
+#define LEDS_SK9822_END_BYTES(_numLeds) ( (_numLeds) / 2 / 8 + 1 )
+#define LEDS_SK9822_BUFSIZE(_numLeds) ( 4 + ((_numLeds) * 4) + 4 + LEDS_SK9822_END_BYTES(_numLeds) )
 
+template<int O0, int O1, int O2>
+static int sLedsPackSK9822(uint8_t *outBuf, const int bufSize, const int stripIx, const uint16_t ledIx0, const uint16_t numLeds)
+{
     // Tim (https://cpldcpu.wordpress.com/2016/12/13/sk9822-a-clone-of-the-apa102/) says:
     // «A protocol that is compatible to both the SK9822 and the APA102 consists of the following:
     //  1. A start frame of 32 zero bits (<0x00> <0x00> <0x00> <0x00> )
@@ -135,6 +289,11 @@ static int sLedsRenderSK9822(uint8_t *outBuf, const int bufSize)
     //  3. A SK9822 reset frame of 32 zero bits (<0x00> <0x00> <0x00> <0x00> ).
     //  4. An end frame consisting of at least (n/2) bits of 0, where n is the number of LEDs in the string.»
 
+    if (bufSize < (int)LEDS_SK9822_BUFSIZE(numLeds))
+    {
+        return 0;
+    }
+
     int outIx = 0;
 
     // 1. start frame
@@ -143,13 +302,14 @@ static int sLedsRenderSK9822(uint8_t *outBuf, const int bufSize)
     outBuf[outIx++] = 0x00;
     outBuf[outIx++] = 0x00;
 
-    // 2. LEDs data
-    for (int ix = 0; (ix < LEDS_NUM) && (outIx < (bufSize - 4 - LEDS_SK9822_END_BYTES )); ix++)
+    // 2. LEDs data, coarse global brightness here, the rest is in the lookup table
+    const uint16_t *pkLut = sLedsOutLut[stripIx];
+    const uint8_t global = 0xe0 | (sLedsSk9822Bright[stripIx] & 0x1f);
+    for (int ix = 0; ix < numLeds; ix++)
     {
-        outBuf[outIx++] = 0xe0 | (brightness & 0x1f); // global brightness
-        outBuf[outIx++] = sLedsData[ix][0];
-        outBuf[outIx++] = sLedsData[ix][1];
-        outBuf[outIx++] = sLedsData[ix][2];
+        outBuf[outIx++] = global;
+        sLedsPackPixel<O0, O1, O2>(&outBuf[outIx], pkLut, ledIx0 + ix);
+        outIx += 3;
     }
 
     // 3. reset frame
@@ -159,7 +319,7 @@ static int sLedsRenderSK9822(uint8_t *outBuf, const int bufSize)
     outBuf[outIx++] = 0x00;
 
     // 4. end frame
-    int n = LEDS_SK9822_END_BYTES;
+    int n = LEDS_SK9822_END_BYTES(numLeds);
     while (n-- > 0)
     {
         outBuf[outIx++] = 0x00;
@@ -168,297 +328,1953 @@ static int sLedsRenderSK9822(uint8_t *outBuf, const int bufSize)
     return outIx;
 }
 
+#if defined(ESP8266)
+// each bit is sent as four I2S bits (0 = 1000, 1 = 1110) at 3.2MHz, i.e. four bytes per byte
+#  define LEDS_WS2812_BUFSIZE ( LEDS_STRIP_MAX * 3 * 4 )
+static const uint16_t skLedsWs2812Nibbles[16] =
+{
+    0x8888, 0x888e, 0x88e8, 0x88ee, 0x8e88, 0x8e8e, 0x8ee8, 0x8eee,
+    0xe888, 0xe88e, 0xe8e8, 0xe8ee, 0xee88, 0xee8e, 0xeee8, 0xeeee
+};
+#  if (LEDS_WS2812_BUFSIZE > 4095)
+#    error LEDS_WS2812_BUFSIZE too big for one SLC descriptor
+#  endif
+#elif defined(ESP32)
+// one RMT item (32 bits) per bit, the RMT ticks at 80MHz / 2 = 40MHz (25ns):
+// 0 = 0.40us high, 0.85us low, 1 = 0.80us high, 0.45us low
+#  define LEDS_WS2812_BUFSIZE ( LEDS_STRIP_MAX * 3 * 8 * 4 )
+#  define LEDS_RMT_CLK_DIV 2
+#  define LEDS_RMT_BIT0 ( (16 << 0) | (1 << 15) | (34 << 16) | (0 << 31) )
+#  define LEDS_RMT_BIT1 ( (32 << 0) | (1 << 15) | (18 << 16) | (0 << 31) )
+#endif
 
-/* *********************************************************************************************** */
+template<int O0, int O1, int O2>
+static int sLedsPackWS2812(uint8_t *outBuf, const int bufSize, const int stripIx, const uint16_t ledIx0, const uint16_t numLeds)
+{
+    const uint16_t *pkLut = sLedsOutLut[stripIx];
+#if defined(ESP8266)
+    const int num = MIN(numLeds, bufSize / (3 * 4));
+    uint32_t *pOut = (uint32_t *)outBuf;
+    for (int ix = 0; ix < num; ix++)
+    {
+        uint8_t pix[3];
+        sLedsPackPixel<O0, O1, O2>(pix, pkLut, ledIx0 + ix);
+        // 16 bit I2S samples, high half-word is sent first
+        pOut[0] = ((uint32_t)skLedsWs2812Nibbles[pix[0] >> 4] << 16) | skLedsWs2812Nibbles[pix[0] & 0x0f];
+        pOut[1] = ((uint32_t)skLedsWs2812Nibbles[pix[1] >> 4] << 16) | skLedsWs2812Nibbles[pix[1] & 0x0f];
+        pOut[2] = ((uint32_t)skLedsWs2812Nibbles[pix[2] >> 4] << 16) | skLedsWs2812Nibbles[pix[2] & 0x0f];
+        pOut += 3;
+    }
+    return num * 3 * 4;
+#elif defined(ESP32)
+    const int num = MIN(numLeds, bufSize / (3 * 8 * 4));
+    uint32_t *pOut = (uint32_t *)outBuf;
+    for (int ix = 0; ix < num; ix++)
+    {
+        uint8_t pix[3];
+        sLedsPackPixel<O0, O1, O2>(pix, pkLut, ledIx0 + ix);
+        for (int c = 0; c < 3; c++)
+        {
+            for (uint8_t mask = 0x80; mask != 0; mask >>= 1)
+            {
+                *pOut++ = (pix[c] & mask) != 0 ? LEDS_RMT_BIT1 : LEDS_RMT_BIT0;
+            }
+        }
+    }
+    return num * 3 * 8 * 4;
+#endif
+}
 
-// copy of working frame buffer for transferring to SPI
-static uint32_t __ALIGN(4) sLedsSpiBuf[ MAX(LEDS_WS2801_BUFSIZE, LEDS_SK9822_BUFSIZE) / 4 + 1 ];
+#define LEDS_PACKER_ORDERS(_order, _packer) \
+    switch (_order) \
+    { \
+        case CFG_ORDER_RGB:     return _packer<_R_, _G_, _B_>; \
+        case CFG_ORDER_RBG:     return _packer<_R_, _B_, _G_>; \
+        case CFG_ORDER_GRB:     return _packer<_G_, _R_, _B_>; \
+        case CFG_ORDER_GBR:     return _packer<_G_, _B_, _R_>; \
+        case CFG_ORDER_BRG:     return _packer<_B_, _R_, _G_>; \
+        case CFG_ORDER_BGR:     return _packer<_B_, _G_, _R_>; \
+        case CFG_ORDER_UNKNOWN: return _packer<LEDS_ORDER_GREY, 0, 0>; \
+    }
 
-// update LEDs (send data to SPI)
-static void sLedsFlush(const CFG_DRIVER_t driver)
+static LEDS_PACK_FUNC_t sLedsPackerWS2801(const CFG_ORDER_t order)
 {
-    // copy framebuffer
-    int nBytesToSend = 0;
+    LEDS_PACKER_ORDERS(order, sLedsPackWS2801);
+    return NULL;
+}
+
+static LEDS_PACK_FUNC_t sLedsPackerWS2812(const CFG_ORDER_t order)
+{
+    LEDS_PACKER_ORDERS(order, sLedsPackWS2812);
+    return NULL;
+}
+
+static LEDS_PACK_FUNC_t sLedsPackerSK9822(const CFG_ORDER_t order)
+{
+    LEDS_PACKER_ORDERS(order, sLedsPackSK9822);
+    return NULL;
+}
+
+// select packer for a strip (and the lookup table) for the current config
+static void sLedsPackSelect(const int stripIx, const CFG_DRIVER_t driver, const CFG_ORDER_t order, const CFG_BRIGHT_t bright)
+{
+    sLedsOutLutBuild(stripIx, driver, bright);
+    sLedsPackWs2812[stripIx] = (driver == CFG_DRIVER_WS2812);
     switch (driver)
     {
         case CFG_DRIVER_UNKNOWN:
+            sLedsPackFunc[stripIx] = NULL;
             break;
         case CFG_DRIVER_WS2801:
-            nBytesToSend = sLedsRenderWS2801((uint8_t *)sLedsSpiBuf, sizeof(sLedsSpiBuf));
+            sLedsPackFunc[stripIx] = sLedsPackerWS2801(order);
+            break;
+        case CFG_DRIVER_WS2812:
+            sLedsPackFunc[stripIx] = sLedsPackerWS2812(order);
             break;
         case CFG_DRIVER_SK9822:
-            nBytesToSend = sLedsRenderSK9822((uint8_t *)sLedsSpiBuf, sizeof(sLedsSpiBuf));
+            sLedsPackFunc[stripIx] = sLedsPackerSK9822(order);
             break;
     }
-    const int nWordsToSend = nBytesToSend / 4 + 1;
-    //DEBUG("sLedsFlush() %d %d", nBytesToSend, nWordsToSend);
-
-    //SPI.begin();
-    SPI.writeBytes((const uint8_t *)sLedsSpiBuf, nBytesToSend);
-    //SPI.end();
 }
 
 
 /* *********************************************************************************************** */
 
-typedef struct LEDS_STATE_s
-{
-    LEDS_PARAM_t param;
-    bool         inited;
-    uint8_t      val;
-    int          count;
+// send frames asynchronously (DMA on ESP32, FIFO interrupts on ESP8266), 0 = wait for the SPI transfer
+#ifndef CONFIG_LEDS_SPI_ASYNC
+#  define CONFIG_LEDS_SPI_ASYNC 1
+#endif
 
-} LEDS_STATE_t;
+// SPI clock, faster for longer strips so that a frame (4 bytes per LED for the SK9822) fits into a tick
+#ifndef CONFIG_LEDS_SPI_FREQ
+#  if (LEDS_STRIP_MAX > 100)
+#    define CONFIG_LEDS_SPI_FREQ 4000000
+#  else
+#    define CONFIG_LEDS_SPI_FREQ 1000000
+#  endif
+#endif
 
-static LEDS_STATE_t sLedsStates[LEDS_NUM];
+#define LEDS_SPI_FREQ CONFIG_LEDS_SPI_FREQ
 
-#define LEDS_PULSE_MIN_VAL 10
+#if defined(ESP32)
+// the second strip is on the HSPI bus, by default on its native pins
+#  ifndef CONFIG_LEDS_SPI1_SCK_PIN
+#    define CONFIG_LEDS_SPI1_SCK_PIN 14
+#  endif
+#  ifndef CONFIG_LEDS_SPI1_MOSI_PIN
+#    define CONFIG_LEDS_SPI1_MOSI_PIN 13
+#  endif
+static const int8_t skLedsSpiSckPin[]  = { CONFIG_SPI_SCK_PIN,  CONFIG_LEDS_SPI1_SCK_PIN };
+static const int8_t skLedsSpiMosiPin[] = { CONFIG_SPI_MOSI_PIN, CONFIG_LEDS_SPI1_MOSI_PIN };
+#endif
 
-void ledsSetState(const uint16_t ledIx, const LEDS_PARAM_t *pkParam)
-{
-    if (ledIx < LEDS_NUM)
-    {
-        //if (memcmp(&sLedsStates[ledIx].param, pkParam, sizeof(*pkParam)) != 0)
-        {
-            memset(&sLedsStates[ledIx], 0, sizeof(*sLedsStates));
-            sLedsStates[ledIx].param = *pkParam;
-        }
-    }
-}
+// copies of working frame buffer for transferring to SPI (for each strip), we render into one while the
+// other is being sent
+static uint32_t __ALIGN(4) sLedsSpiBuf[LEDS_NUM_STRIPS][2][ MAX(MAX(LEDS_WS2801_BUFSIZE, LEDS_SK9822_BUFSIZE(LEDS_STRIP_MAX)), LEDS_WS2812_BUFSIZE) / 4 + 1 ];
+static int sLedsSpiBufSize[LEDS_NUM_STRIPS][NUMOF(sLedsSpiBuf[0])];
+static volatile bool sLedsSpiBufBusy[LEDS_NUM_STRIPS][NUMOF(sLedsSpiBuf[0])]; // being sent (or waiting to be sent), don't touch
+static int sLedsSpiLastIx[LEDS_NUM_STRIPS];         // buffer we sent last
+static uint32_t sLedsSpiLastTick[LEDS_NUM_STRIPS];  // when we sent it
+
+// nominal time between ticks [us]
+#define LEDS_TICK_US (1000000 / LEDS_FPS)
+
+// re-send unchanged data every once in a while (in case the strip picked up a glitch)
+#define LEDS_REFRESH_TICKS (1 * LEDS_FPS)
+
+// statistics
+static uint32_t sLedsNumFrames;
+static uint32_t sLedsNumRendered;
+static uint32_t sLedsNumFlushed;
+static uint32_t sLedsNumDropped;
+static uint32_t sLedsSpiWaitSum[LEDS_NUM_STRIPS]; // [us]
+static uint32_t sLedsSpiWaitMax[LEDS_NUM_STRIPS]; // [us]
+static uint32_t sLedsSpiWaitNum[LEDS_NUM_STRIPS];
+static uint32_t sLedsPackTimeSum[LEDS_NUM_STRIPS]; // [us]
+static uint32_t sLedsPackTimeMax[LEDS_NUM_STRIPS]; // [us]
+static uint32_t sLedsPackTimeNum[LEDS_NUM_STRIPS];
+static uint32_t sLedsRenderTimeSum; // [us]
+static uint32_t sLedsRenderTimeMax; // [us]
+static uint32_t sLedsRenderTimeNum;
+
+// animation clock: effects advance by the time elapsed since the last tick, not by the number of ticks,
+// so that a late (or skipped) tick is caught up in the next frame
+static uint32_t sLedsClockLast;   // [us] time of the last tick
+static uint32_t sLedsClockRem;    // [us] remainder not yet handed out to the effects
+static uint32_t sLedsClockLate;   // number of late ticks (> 1.5 frames)
+static uint32_t sLedsClockMissed; // number of frames missed (late ticks, in frames)
+static uint32_t sLedsClockMax;    // [us] longest interval between ticks
+static const uint16_t skLedsClockHistBins[] = { 5, 8, 12, 15, 20, 50, 100 }; // [ms] upper bounds of the histogram bins
+static uint32_t sLedsClockHist[NUMOF(skLedsClockHistBins) + 1];
+
+// adaptive frame rate: render only every sLedsTickDiv-th tick if the active effects don't need more
+static uint16_t sLedsTickDiv = 1;  // ticks per frame
+static uint16_t sLedsTickCnt;      // ticks since the last rendered frame
+static uint32_t sLedsTickAcc;      // [ms] time elapsed since the last rendered frame
+static uint32_t sLedsTickDivHist[4]; // number of frames rendered at 1, 2, 3..4, and 5+ ticks per frame
+
+// frame rate [Hz] needed for a smooth crossfade
+#define LEDS_FADE_FPS 50
 
-static const int sLedsPulseAmpl[] =
+// longest time [ms] an animation advances in one frame (e.g. after the system was stuck for a while)
+#define LEDS_CLOCK_MAX_DT 1000
+
+// per-stage profiler using the CPU cycle counter, 0 = compile it out
+#ifndef CONFIG_LEDS_PROFILE
+#  define CONFIG_LEDS_PROFILE 1
+#endif
+
+#if (CONFIG_LEDS_PROFILE > 0)
+typedef enum LEDS_PROF_e
 {
-#if (LEDS_FPS == 100)
-    // floor(sin(0:pi/2/100:pi).*100)
-    0, 1, 3, 4, 6, 7, 9, 10, 12, 14, 15, 17, 18, 20, 21, 23, 24, 26, 27, 29, 30, 32, 33, 35, 36, 38, 39,
-    41, 42, 43, 45, 46, 48, 49, 50, 52, 53, 54, 56, 57, 58, 60, 61, 62, 63, 64, 66, 67, 68, 69, 70, 71,
-    72, 73, 75, 76, 77, 78, 79, 79, 80, 81, 82, 83, 84, 85, 86, 86, 87, 88, 89, 89, 90, 91, 91, 92, 92,
-    93, 94, 94, 95, 95, 96, 96, 96, 97, 97, 97, 98, 98, 98, 99, 99, 99, 99, 99, 99, 99, 99, 99, 100, 99,
-    99, 99, 99, 99, 99, 99, 99, 99, 98, 98, 98, 97, 97, 97, 96, 96, 96, 95, 95, 94, 94, 93, 92, 92, 91,
-    91, 90, 89, 89, 88, 87, 86, 86, 85, 84, 83, 82, 81, 80, 79, 79, 78, 77, 76, 75, 73, 72, 71, 70, 69,
-    68, 67, 66, 64, 63, 62, 61, 60, 58, 57, 56, 54, 53, 52, 50, 49, 48, 46, 45, 43, 42, 41, 39, 38, 36,
-    35, 33, 32, 30, 29, 27, 26, 24, 23, 21, 20, 18, 17, 15, 14, 12, 10, 9, 7, 6, 4, 3, 1, 0,
+    LEDS_PROF_FX,   // effects
+    LEDS_PROF_HSV,  // hsv2rgbMany()
+    LEDS_PROF_FADE, // crossfades
+    LEDS_PROF_MAP,  // channels to LEDs
+    LEDS_PROF_PACK, // packer
+    LEDS_PROF_OUT,  // SPI / WS2812 output (time blocked by it)
+    LEDS_PROF_TASK, // all of the above, and the rest of sLedsTask()
+    _LEDS_PROF_NUM
+} LEDS_PROF_t;
+static const char * const skLedsProfNames[] = { "fx", "hsv", "fade", "map", "pack", "out", "task" };
+static uint32_t sLedsProfCyc[_LEDS_PROF_NUM];    // [cycles] current frame
+static uint64_t sLedsProfCycSum[_LEDS_PROF_NUM]; // [cycles]
+static uint32_t sLedsProfCycMin[_LEDS_PROF_NUM]; // [cycles]
+static uint32_t sLedsProfCycMax[_LEDS_PROF_NUM]; // [cycles]
+static uint32_t sLedsProfNum;    // number of frames profiled
+static uint32_t sLedsProfMhz;    // CPU frequency of these frames (cycles are only comparable at the same frequency)
+static uint32_t sLedsProfOver;   // number of frames over budget
+#  define LEDS_PROF_BEGIN(_t)       const uint32_t _t = ESP.getCycleCount()
+#  define LEDS_PROF_END(_stage, _t) sLedsProfCyc[_stage] += ESP.getCycleCount() - (_t)
 #else
-#  error missing LUT for LEDS_FPS value
+#  define LEDS_PROF_BEGIN(_t)       /* nothing */
+#  define LEDS_PROF_END(_stage, _t) /* nothing */
 #endif
-};
 
-static void sLedsRenderFx(LEDS_STATE_t *pState, uint8_t *pHue, uint8_t *pSat, uint8_t *pVal)
+#if (CONFIG_LEDS_SPI_ASYNC > 0) && defined(ESP8266)
+
+// the HSPI FIFO is 64 bytes (16 words), refill it from the "transfer done" interrupt
+static volatile const uint32_t *sLedsSpiTxPtr;
+static volatile int sLedsSpiTxLeft;
+static volatile int sLedsSpiTxIx   = -1; // buffer being sent
+static volatile int sLedsSpiTxNext = -1; // buffer to send next
+
+static void ICACHE_RAM_ATTR sLedsSpiTxChunk(void)
 {
-    if (!pState->inited)
+    const int nBytes = MIN(sLedsSpiTxLeft, 64);
+    const uint32_t nBits = (nBytes * 8) - 1;
+    volatile uint32_t *pFifo = &SPI1W0;
+    for (int ix = 0; ix < ((nBytes + 3) / 4); ix++)
     {
-        switch (pState->param.fx)
-        {
-            case LEDS_FX_STILL:
-                break;
-            case LEDS_FX_PULSE:
-                pState->count = pState->param.arg;
-                break;
-            case LEDS_FX_FLICKER:
-                pState->count = pState->param.arg;
-                break;
-            case LEDS_FX_BLINK:
-                pState->count = -pState->param.arg;
-                break;
-        }
-        pState->inited = true;
+        pFifo[ix] = sLedsSpiTxPtr[ix];
     }
+    SPI1U1 = (SPI1U1 & ~((SPIMMOSI << SPILMOSI) | (SPIMMISO << SPILMISO))) |
+        ((nBits << SPILMOSI) | (nBits << SPILMISO));
+    sLedsSpiTxPtr  += 16;
+    sLedsSpiTxLeft -= nBytes;
+    SPI1CMD |= SPIBUSY;
+}
 
-    uint8_t hue = 0, sat = 0, val = 0;
+static void ICACHE_RAM_ATTR sLedsSpiTxStart(const int bufIx)
+{
+    sLedsSpiTxIx   = bufIx;
+    sLedsSpiTxPtr  = sLedsSpiBuf[0][bufIx]; // only one strip on the ESP8266
+    sLedsSpiTxLeft = sLedsSpiBufSize[0][bufIx];
+    sLedsSpiTxChunk();
+}
 
-    switch (pState->param.fx)
+static void ICACHE_RAM_ATTR sLedsSpiIsr(void *arg)
+{
+    UNUSED(arg);
+    const uint32_t status = SPIIR;
+    if (status & (1 << SPII1))
     {
-        case LEDS_FX_STILL:
+        SPI1S &= ~SPISTRIS; // clear
+        if (sLedsSpiTxLeft > 0)
         {
-            hue = pState->param.hue;
-            sat = pState->param.sat;
-            val = pState->param.val;
-            break;
-        }
-        case LEDS_FX_PULSE:
-        {
-            const uint8_t minVal = MAX(10, pState->param.val / 10);
-            pState->val = minVal + (( (pState->param.val - minVal) * sLedsPulseAmpl[pState->count] ) / 100);
-            pState->count++;
-            pState->count %= NUMOF(sLedsPulseAmpl);
-            hue = pState->param.hue;
-            sat = pState->param.sat;
-            val = pState->val;
-            break;
-        }
-        case LEDS_FX_FLICKER:
-        {
-            // probabilites by "Eric", commented on
-            // https://cpldcpu.wordpress.com/2016/01/05/reverse-engineering-a-real-candle/#comment-1809
-            // Probability  Random LED Brightness                               value 0..255
-            //  50%          77% -  80% (its barely noticeable)                 196..204
-            //  30%          80% - 100% (very noticeable, sim. air flicker)     204..255
-            //   5%          50% -  80% (very noticeable, blown out flame)      128..204
-            //   5%          40% -  50% (very noticeable, blown out flame)      102..128
-            //  10%          30% -  40% (very noticeable, blown out flame)       77..102
-            // Probability  Random Time (Duration)
-            //  90%          20 ms
-            //   3%          20 - 30 ms
-            //   3%          10 - 20 ms
-            //   4%           0 - 10 ms
-            if (pState->count == 0)
-            {
-                const int pBright = rand() % 100;
-                if      (pBright < 50)  { pState->val = 196 + (rand() % (204 - 196)); }
-                else if (pBright < 80)  { pState->val = 204 + (rand() % (255 - 204)); }
-                else if (pBright < 85)  { pState->val = 128 + (rand() % (204 - 128)); }
-                else if (pBright < 90)  { pState->val = 102 + (rand() % (128 - 102)); }
-                else                    { pState->val =  77 + (rand() % (102 -  77)); }
-
-                const int pTime = rand() % 100;
-                if      (pTime < 90) { pState->count =  20                         / (1000 / LEDS_FPS / 2); }
-                else if (pTime < 93) { pState->count = (20 + (rand() % (30 - 20))) / (1000 / LEDS_FPS / 2); }
-                else if (pTime < 96) { pState->count = (10 + (rand() % (20 - 10))) / (1000 / LEDS_FPS / 2); }
-                else                 { pState->count = (      rand() %  10       ) / (1000 / LEDS_FPS / 2); }
-            }
-            else
-            {
-                pState->count--;
-            }
-            hue = pState->param.hue;
-            sat = pState->param.sat;
-            val = pState->val / (pState->param.val != 0 ? (256 / pState->param.val) : 1);
-            break;
+            sLedsSpiTxChunk();
         }
-        case LEDS_FX_BLINK:
+        else
         {
-            if (pState->param.arg > 0)
-            {
-                pState->count++;
-                if (pState->count >= pState->param.arg)
-                {
-                    pState->param.arg = -pState->param.arg;
-                }
-                hue = pState->param.hue;
-                sat = pState->param.sat;
-                val = pState->param.val;
-            }
-            else if (pState->param.arg < 0)
+            sLedsSpiBufBusy[0][sLedsSpiTxIx] = false;
+            sLedsSpiTxIx = -1;
+            if (sLedsSpiTxNext >= 0)
             {
-                pState->count--;
-                if (pState->count <= pState->param.arg)
-                {
-                    pState->param.arg = -pState->param.arg;
-                }
-                hue = 0;
-                sat = 0;
-                val = 0;
+                sLedsSpiTxStart(sLedsSpiTxNext);
+                sLedsSpiTxNext = -1;
             }
-            break;
         }
     }
+    else if (status & (1 << SPII0))
+    {
+        SPI0S &= ~(0x3ff); // flash, not ours
+    }
+}
 
-    *pHue = hue;
-    *pSat = sat;
-    *pVal = val;
+static void sLedsSpiInit(void)
+{
+    SPI.pins(CONFIG_SPI_SCK_PIN, CONFIG_SPI_MISO_PIN, CONFIG_SPI_MOSI_PIN, CONFIG_SPI_SS_PIN);
+    SPI.begin();
+    SPI.setFrequency(LEDS_SPI_FREQ);
+    SPI1S = (SPI1S & ~0x3ff) | SPISTRIE; // only the "transfer done" interrupt
+    ETS_SPI_INTR_ATTACH(sLedsSpiIsr, NULL);
+    ETS_SPI_INTR_ENABLE();
 }
 
-static void sLedsTask(void)
+static void sLedsSpiPoll(const int stripIx)
 {
-    static CFG_DRIVER_t sConfigDriverLast = CFG_DRIVER_UNKNOWN;
-    static CFG_ORDER_t  sConfigOrderLast  = CFG_ORDER_UNKNOWN;
-    static CFG_BRIGHT_t sConfigBrightLast = CFG_BRIGHT_UNKNOWN;
+    UNUSED(stripIx);
+}
 
-    //while (true)
+static void sLedsSpiSend(const int stripIx, const int bufIx)
+{
+    UNUSED(stripIx);
+    sLedsSpiBufBusy[0][bufIx] = true;
+    ETS_SPI_INTR_DISABLE();
+    if (sLedsSpiTxIx < 0)
     {
-        const CFG_DRIVER_t configDriver = cfgGetDriver();
-        const CFG_ORDER_t  configOrder  = cfgGetOrder();
-        const CFG_BRIGHT_t configBright = cfgGetBright();
+        sLedsSpiTxStart(bufIx);
+    }
+    else
+    {
+        sLedsSpiTxNext = bufIx; // the ISR will start it
+    }
+    ETS_SPI_INTR_ENABLE();
+}
 
-        // handle config changes
-        if (sConfigDriverLast != configDriver)
-        {
-            DEBUG("leds: driver change");
-            sLedsClear();
-            sLedsFlush(sConfigDriverLast);
-            sConfigDriverLast = configDriver;
-        }
-        if (sConfigOrderLast != configOrder)
-        {
-            DEBUG("leds: order change");
-            sConfigOrderLast = configOrder;
-        }
-        if (sConfigBrightLast != configBright)
-        {
-            DEBUG("leds: bright change");
-            sConfigBrightLast = configBright;
-        }
+#elif (CONFIG_LEDS_SPI_ASYNC > 0) && defined(ESP32)
 
-        // cannot do much if we don't know the driver
-        if (cfgGetDriver() == CFG_DRIVER_UNKNOWN)
-        {
-            return;
-        }
+// one bus for each strip, with its own DMA channel, so that the strips are sent at the same time
+static const spi_host_device_t skLedsSpiHost[] = { VSPI_HOST, HSPI_HOST };
+static spi_device_handle_t sLedsSpiDev[LEDS_NUM_STRIPS];
+static spi_transaction_t sLedsSpiTrans[LEDS_NUM_STRIPS][NUMOF(sLedsSpiBuf[0])];
 
-        // render next frame..
-        static uint32_t sTick;
-        sLedsClear();
-        for (uint16_t ix = 0; ix < NUMOF(sLedsStates); ix++)
+static void sLedsSpiInit(void)
+{
+    for (int stripIx = 0; stripIx < LEDS_NUM_STRIPS; stripIx++)
+    {
+        spi_bus_config_t busCfg;
+        memset(&busCfg, 0, sizeof(busCfg));
+        busCfg.mosi_io_num     = skLedsSpiMosiPin[stripIx];
+        busCfg.miso_io_num     = -1;
+        busCfg.sclk_io_num     = skLedsSpiSckPin[stripIx];
+        busCfg.quadwp_io_num   = -1;
+        busCfg.quadhd_io_num   = -1;
+        busCfg.max_transfer_sz = sizeof(sLedsSpiBuf[0][0]);
+        spi_device_interface_config_t devCfg;
+        memset(&devCfg, 0, sizeof(devCfg));
+        devCfg.clock_speed_hz = LEDS_SPI_FREQ;
+        devCfg.mode           = 0;
+        devCfg.spics_io_num   = -1;
+        devCfg.queue_size     = NUMOF(sLedsSpiBuf[0]);
+        if ( (spi_bus_initialize(skLedsSpiHost[stripIx], &busCfg, stripIx + 1) != ESP_OK) ||
+             (spi_bus_add_device(skLedsSpiHost[stripIx], &devCfg, &sLedsSpiDev[stripIx]) != ESP_OK) )
         {
-            uint8_t h = 0, s = 0, v = 0;
-            sLedsRenderFx(&sLedsStates[ix], &h, &s, &v);
-            sLedsSetHSV(ix, h, s, v);
+            ERROR("leds: spi init (strip %d)", stripIx);
         }
-        sLedsFlush(configDriver);
     }
 }
 
+// collect finished transfers
+static void sLedsSpiPoll(const int stripIx)
+{
+    spi_transaction_t *pTrans = NULL;
+    while (spi_device_get_trans_result(sLedsSpiDev[stripIx], &pTrans, 0) == ESP_OK)
+    {
+        sLedsSpiBufBusy[stripIx][(intptr_t)pTrans->user] = false;
+    }
+}
 
-void ledsSetStateHello(const LEDS_PARAM_t *pkParamHead, const LEDS_PARAM_t *pkParamBow)
+static void sLedsSpiSend(const int stripIx, const int bufIx)
 {
-    if (pkParamHead != NULL)
+    spi_transaction_t *pTrans = &sLedsSpiTrans[stripIx][bufIx];
+    memset(pTrans, 0, sizeof(*pTrans));
+    pTrans->length    = sLedsSpiBufSize[stripIx][bufIx] * 8;
+    pTrans->tx_buffer = sLedsSpiBuf[stripIx][bufIx];
+    pTrans->user      = (void *)(intptr_t)bufIx;
+    sLedsSpiBufBusy[stripIx][bufIx] = true;
+    if (spi_device_queue_trans(sLedsSpiDev[stripIx], pTrans, 0) != ESP_OK)
     {
-        for (int ix = 0; ix < 6; ix++)
-        {
-            LEDS_PARAM_t param1 = *pkParamHead;
-            param1.arg = (30 * ix);
-            ledsSetState(ix, &param1);
-            LEDS_PARAM_t param2 = *pkParamHead;
-            param2.arg = (30 * ix) + (30 / 2);
-            ledsSetState(ix + 6, &param2);
-        }
+        sLedsSpiBufBusy[stripIx][bufIx] = false;
     }
-    if (pkParamBow != NULL)
+}
+
+#else
+
+// the strips are sent one after the other
+#  if (LEDS_NUM_STRIPS > 1)
+static SPIClass sLedsSpi1(HSPI);
+static SPIClass * const skLedsSpi[] = { &SPI, &sLedsSpi1 };
+#  else
+static SPIClass * const skLedsSpi[] = { &SPI };
+#  endif
+
+static void sLedsSpiInit(void)
+{
+#  if defined(ESP8266)
+    SPI.pins(CONFIG_SPI_SCK_PIN, CONFIG_SPI_MISO_PIN, CONFIG_SPI_MOSI_PIN, CONFIG_SPI_SS_PIN);
+    SPI.begin();
+    SPI.setFrequency(LEDS_SPI_FREQ);
+#  elif defined(ESP32)
+    for (int stripIx = 0; stripIx < LEDS_NUM_STRIPS; stripIx++)
     {
-        ledsSetState(12, pkParamBow);
+        skLedsSpi[stripIx]->begin(skLedsSpiSckPin[stripIx], -1, skLedsSpiMosiPin[stripIx], -1);
+        skLedsSpi[stripIx]->setFrequency(LEDS_SPI_FREQ);
     }
+#  endif
+}
+
+static void sLedsSpiPoll(const int stripIx)
+{
+    UNUSED(stripIx);
+}
+
+static void sLedsSpiSend(const int stripIx, const int bufIx)
+{
+    //SPI.begin();
+    skLedsSpi[stripIx]->writeBytes((const uint8_t *)sLedsSpiBuf[stripIx][bufIx], sLedsSpiBufSize[stripIx][bufIx]);
+    //SPI.end();
 }
 
+#endif
+
 
 /* *********************************************************************************************** */
 
-Ticker sLedsTaskTicker;
+// WS2812 output, the bits are encoded by the packer and sent by the I2S (ESP8266) or RMT (ESP32) peripheral
 
-void ledsInit(void)
-{
-    DEBUG("leds: init (sckPin=" STRINGIFY(CONFIG_SPI_SCK_PIN) ", misoPin=" STRINGIFY(CONFIG_SPI_MISO_PIN)
-        ", mosiPin=" STRINGIFY(CONFIG_SPI_MOSI_PIN) ", ssPin=" STRINGIFY(CONFIG_SPI_SS_PIN)
-        ", numLeds=%u, bufSize=%u, ws2801buf=%u, sk9822buf=%u, spi=%ux4=%u)",
-        LEDS_NUM, sizeof(sLedsData),
-        LEDS_WS2801_BUFSIZE, LEDS_SK9822_BUFSIZE,
-        NUMOF(sLedsSpiBuf), sizeof(sLedsSpiBuf));
+// data line to the WS2812
+#ifndef CONFIG_LEDS_WS2812_PIN
+#  if defined(ESP8266)
+#    define CONFIG_LEDS_WS2812_PIN 3 // the I2S data output (RX)
+#  elif defined(ESP32)
+#    define CONFIG_LEDS_WS2812_PIN CONFIG_SPI_MOSI_PIN // any pin will do for the RMT
+#  endif
+#endif
 
-#if defined(ESP8266)
-    SPI.pins(CONFIG_SPI_SCK_PIN, CONFIG_SPI_MISO_PIN, CONFIG_SPI_MOSI_PIN, CONFIG_SPI_SS_PIN);
-    SPI.begin();
-#elif defined(ESP32)
-    SPI.begin(CONFIG_SPI_SCK_PIN, -1, CONFIG_SPI_MOSI_PIN, -1);
+#if defined(ESP8266) && (CONFIG_LEDS_WS2812_PIN != 3)
+#  error CONFIG_LEDS_WS2812_PIN must be 3 (I2S data out) on the ESP8266
 #endif
-    SPI.setFrequency(1000000);
-    
-    memset(&sLedsStates, 0, sizeof(sLedsStates));
 
-    sLedsClear();
-    sLedsFlush(CFG_DRIVER_SK9822);
-    delay(100);
-    sLedsFlush(CFG_DRIVER_WS2801);
-    delay(100);
-    
+// data line to the second WS2812 strip (on the second RMT channel)
+#if defined(ESP32) && !defined(CONFIG_LEDS_WS2812_PIN1)
+#  define CONFIG_LEDS_WS2812_PIN1 CONFIG_LEDS_SPI1_MOSI_PIN
+#endif
+
+// WS2812 output peripheral is in use (for each strip)
+static bool sLedsWs2812Active[LEDS_NUM_STRIPS];
+
+#if defined(ESP8266)
+
+// SLC (DMA) descriptor, see also the Arduino core's I2S code
+typedef struct LEDS_SLC_DESC_s
+{
+    uint32_t          blocksize : 12;
+    uint32_t          datalen   : 12;
+    uint32_t          unused    :  5;
+    uint32_t          sub_sof   :  1;
+    uint32_t          eof       :  1;
+    volatile uint32_t owner     :  1;
+    const uint32_t   *buf_ptr;
+    volatile struct LEDS_SLC_DESC_s *next_link_ptr;
+
+} LEDS_SLC_DESC_t;
+
+// one descriptor per frame buffer, and one for the idle (reset) time between frames that loops on itself
+static volatile LEDS_SLC_DESC_t sLedsI2sDesc[NUMOF(sLedsSpiBuf[0])];
+static volatile LEDS_SLC_DESC_t sLedsI2sIdleDesc;
+static const uint32_t sLedsI2sIdleBuf[32]; // 128 bytes = 320us low
+static volatile int sLedsI2sTxIx   = -1; // buffer being sent
+static volatile int sLedsI2sTxNext = -1; // buffer to send next
+
+// 160MHz / 5 / 10 = 3.2MHz I2S bit clock, four bits per WS2812 bit (800kHz)
+#define LEDS_I2S_CLKM_DIV 5
+#define LEDS_I2S_BCK_DIV 10
+
+// end of frame, queue the next one (if any)
+static void ICACHE_RAM_ATTR sLedsI2sIsr(void *arg)
+{
+    UNUSED(arg);
+    const uint32_t status = SLCIS;
+    SLCIC = 0xffffffff;
+    if ( ((status & SLCIRXEOF) != 0) && (sLedsI2sTxIx >= 0) &&
+         ((volatile LEDS_SLC_DESC_t *)SLCRXEDA == &sLedsI2sDesc[sLedsI2sTxIx]) )
+    {
+        // the DMA is now in the idle descriptor, there's plenty of time to change its link
+        sLedsSpiBufBusy[0][sLedsI2sTxIx] = false; // only one strip on the ESP8266
+        sLedsI2sTxIx = sLedsI2sTxNext;
+        sLedsI2sTxNext = -1;
+        sLedsI2sIdleDesc.next_link_ptr = sLedsI2sTxIx >= 0 ? &sLedsI2sDesc[sLedsI2sTxIx] : &sLedsI2sIdleDesc;
+    }
+}
+
+static void sLedsWs2812Start(const int stripIx)
+{
+    UNUSED(stripIx);
+    DEBUG("leds: ws2812 start (i2s, pin %d)", CONFIG_LEDS_WS2812_PIN);
+
+    sLedsI2sIdleDesc.blocksize     = sizeof(sLedsI2sIdleBuf);
+    sLedsI2sIdleDesc.datalen       = sizeof(sLedsI2sIdleBuf);
+    sLedsI2sIdleDesc.sub_sof       = 0;
+    sLedsI2sIdleDesc.eof           = 0;
+    sLedsI2sIdleDesc.owner         = 1;
+    sLedsI2sIdleDesc.buf_ptr       = sLedsI2sIdleBuf;
+    sLedsI2sIdleDesc.next_link_ptr = &sLedsI2sIdleDesc;
+    sLedsI2sTxIx   = -1;
+    sLedsI2sTxNext = -1;
+
+    // reset and configure the DMA, to send data to the I2S we use the "rx" link, the "tx" link is unused
+    // but it needs a valid descriptor nevertheless
+    ETS_SLC_INTR_DISABLE();
+    SLCC0 |= SLCRXLR | SLCTXLR;
+    SLCC0 &= ~(SLCRXLR | SLCTXLR);
+    SLCIC = 0xffffffff;
+    SLCC0 &= ~(SLCMM << SLCM);
+    SLCC0 |= (1 << SLCM);
+    SLCRXDC |= SLCBINR | SLCBTNR;
+    SLCRXDC &= ~(SLCBRXFE | SLCBRXEM | SLCBRXFM);
+    SLCTXL &= ~(SLCTXLAM << SLCTXLA);
+    SLCTXL |= (uint32_t)&sLedsI2sIdleDesc << SLCTXLA;
+    SLCRXL &= ~(SLCRXLAM << SLCRXLA);
+    SLCRXL |= (uint32_t)&sLedsI2sIdleDesc << SLCRXLA;
+    ETS_SLC_INTR_ATTACH(sLedsI2sIsr, NULL);
+    SLCIE = SLCIRXEOF;
+    ETS_SLC_INTR_ENABLE();
+    SLCTXL |= SLCTXLS;
+    SLCRXL |= SLCRXLS;
+
+    // configure I2S: 16 bits dual channel, DMA, transmit only
+    pinMode(CONFIG_LEDS_WS2812_PIN, FUNCTION_1); // I2SO_DATA
+    I2S_CLK_ENABLE();
+    I2SIC = 0x3f;
+    I2SIE = 0;
+    I2SC &= ~I2SRST;
+    I2SC |= I2SRST;
+    I2SC &= ~I2SRST;
+    I2SFC &= ~(I2SDE | (I2STXFMM << I2STXFM) | (I2SRXFMM << I2SRXFM));
+    I2SFC |= I2SDE;
+    I2SCC &= ~((I2STXCMM << I2STXCM) | (I2SRXCMM << I2SRXCM));
+    I2SC &= ~(I2STSM | I2SRSM | (I2SBMM << I2SBM) | (I2SBDM << I2SBD) | (I2SCDM << I2SCD));
+    I2SC |= I2SRF | I2SMR | I2SRSM | I2SRMS | (LEDS_I2S_BCK_DIV << I2SBD) | (LEDS_I2S_CLKM_DIV << I2SCD);
+    I2SC |= I2STXS;
+}
+
+static void sLedsWs2812Stop(const int stripIx)
+{
+    UNUSED(stripIx);
+    DEBUG("leds: ws2812 stop");
+    I2SC &= ~I2STXS;
+    ETS_SLC_INTR_DISABLE();
+    SLCIE = 0;
+    SLCIC = 0xffffffff;
+    SLCTXL &= ~(SLCTXLAM << SLCTXLA);
+    SLCRXL &= ~(SLCRXLAM << SLCRXLA);
+    I2S_CLK_DISABLE();
+    pinMode(CONFIG_LEDS_WS2812_PIN, FUNCTION_0); // back to UART0 RX
+    sLedsI2sTxIx   = -1;
+    sLedsI2sTxNext = -1;
+}
+
+static void sLedsWs2812Poll(const int stripIx)
+{
+    UNUSED(stripIx);
+}
+
+// the ISR links the next buffer, so we can always send the free one
+static bool sLedsWs2812Busy(const int stripIx)
+{
+    UNUSED(stripIx);
+    return false;
+}
+
+static void sLedsWs2812Send(const int stripIx, const int bufIx)
+{
+    UNUSED(stripIx);
+    volatile LEDS_SLC_DESC_t *pDesc = &sLedsI2sDesc[bufIx];
+    pDesc->blocksize     = sLedsSpiBufSize[0][bufIx];
+    pDesc->datalen       = sLedsSpiBufSize[0][bufIx];
+    pDesc->sub_sof       = 0;
+    pDesc->eof           = 1;
+    pDesc->owner         = 1;
+    pDesc->buf_ptr       = sLedsSpiBuf[0][bufIx];
+    pDesc->next_link_ptr = &sLedsI2sIdleDesc;
+    sLedsSpiBufBusy[0][bufIx] = true;
+    ETS_SLC_INTR_DISABLE();
+    if (sLedsI2sTxIx < 0)
+    {
+        sLedsI2sTxIx = bufIx;
+        sLedsI2sIdleDesc.next_link_ptr = pDesc;
+    }
+    else
+    {
+        sLedsI2sTxNext = bufIx; // the ISR will link it
+    }
+    ETS_SLC_INTR_ENABLE();
+}
+
+#elif defined(ESP32)
+
+// one RMT channel for each strip, they run at the same time
+static const rmt_channel_t skLedsRmtCh[] = { RMT_CHANNEL_0, RMT_CHANNEL_1 };
+static const int8_t skLedsWs2812Pin[] = { CONFIG_LEDS_WS2812_PIN, CONFIG_LEDS_WS2812_PIN1 };
+static const uint32_t skLedsSpiOutIdx[] = { VSPID_OUT_IDX, HSPID_OUT_IDX };
+
+static int sLedsRmtTxIx[LEDS_NUM_STRIPS]; // buffer being sent (-1 = none)
+
+static void sLedsWs2812Start(const int stripIx)
+{
+    DEBUG("leds: ws2812 start (rmt %d, pin %d)", skLedsRmtCh[stripIx], skLedsWs2812Pin[stripIx]);
+    rmt_config_t rmtCfg;
+    memset(&rmtCfg, 0, sizeof(rmtCfg));
+    rmtCfg.rmt_mode                 = RMT_MODE_TX;
+    rmtCfg.channel                  = skLedsRmtCh[stripIx];
+    rmtCfg.gpio_num                 = (gpio_num_t)skLedsWs2812Pin[stripIx];
+    rmtCfg.mem_block_num            = 1;
+    rmtCfg.clk_div                  = LEDS_RMT_CLK_DIV;
+    rmtCfg.tx_config.idle_output_en = true;
+    rmtCfg.tx_config.idle_level     = RMT_IDLE_LEVEL_LOW;
+    if ( (rmt_config(&rmtCfg) != ESP_OK) || (rmt_driver_install(skLedsRmtCh[stripIx], 0, 0) != ESP_OK) )
+    {
+        ERROR("leds: rmt init (strip %d)", stripIx);
+    }
+    sLedsRmtTxIx[stripIx] = -1;
+}
+
+// collect finished transfer
+static void sLedsWs2812Poll(const int stripIx)
+{
+    if ( (sLedsRmtTxIx[stripIx] >= 0) && (rmt_wait_tx_done(skLedsRmtCh[stripIx], 0) == ESP_OK) )
+    {
+        sLedsSpiBufBusy[stripIx][sLedsRmtTxIx[stripIx]] = false;
+        sLedsRmtTxIx[stripIx] = -1;
+    }
+}
+
+// there's only one RMT transfer at a time (per channel), so we can't send while the previous one is going
+static bool sLedsWs2812Busy(const int stripIx)
+{
+    return sLedsRmtTxIx[stripIx] >= 0;
+}
+
+static void sLedsWs2812Stop(const int stripIx)
+{
+    DEBUG("leds: ws2812 stop (rmt %d)", skLedsRmtCh[stripIx]);
+    rmt_driver_uninstall(skLedsRmtCh[stripIx]);
+    sLedsRmtTxIx[stripIx] = -1;
+    // give the pin back to the SPI
+    if (skLedsWs2812Pin[stripIx] == skLedsSpiMosiPin[stripIx])
+    {
+        gpio_matrix_out(skLedsSpiMosiPin[stripIx], skLedsSpiOutIdx[stripIx], false, false);
+    }
+}
+
+// (only when the previous transfer is done, see sLedsWs2812Busy())
+static void sLedsWs2812Send(const int stripIx, const int bufIx)
+{
+    sLedsSpiBufBusy[stripIx][bufIx] = true;
+    sLedsRmtTxIx[stripIx] = bufIx;
+    if (rmt_write_items(skLedsRmtCh[stripIx], (const rmt_item32_t *)sLedsSpiBuf[stripIx][bufIx],
+            sLedsSpiBufSize[stripIx][bufIx] / 4, false) != ESP_OK)
+    {
+        sLedsSpiBufBusy[stripIx][bufIx] = false;
+        sLedsRmtTxIx[stripIx] = -1;
+    }
+}
+
+#endif
+
+
+/* *********************************************************************************************** */
+
+// [ticks] max. time to wait for the last frame to go out on the previous output peripheral
+#define LEDS_SWITCH_MAX_WAIT 5
+
+// output peripheral switch pending (for each strip), number of ticks waited so far
+static uint8_t sLedsSwitchWait[LEDS_NUM_STRIPS];
+
+// collect finished transfers
+static void sLedsPollStrip(const int stripIx)
+{
+    if (sLedsWs2812Active[stripIx])
+    {
+        sLedsWs2812Poll(stripIx);
+    }
+    else
+    {
+        sLedsSpiPoll(stripIx);
+    }
+}
+
+// is an output peripheral switch pending (see sLedsFlushStrip())?
+static bool sLedsSwitchPending(void)
+{
+    for (int stripIx = 0; stripIx < LEDS_NUM_STRIPS; stripIx++)
+    {
+        if (sLedsPackWs2812[stripIx] != sLedsWs2812Active[stripIx])
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+// update a strip (send data to SPI or WS2812), force = send even if nothing changed
+static void sLedsFlushStrip(const int stripIx, const bool force)
+{
+    // switch output peripheral, but let the last frame go out on the previous one first (we don't wait for
+    // that here, we drop frames and try again on the next tick, see sLedsTask())
+    if (sLedsPackWs2812[stripIx] != sLedsWs2812Active[stripIx])
+    {
+        sLedsPollStrip(stripIx);
+        if ( (sLedsSpiBufBusy[stripIx][0] || sLedsSpiBufBusy[stripIx][1]) &&
+             (sLedsSwitchWait[stripIx] < LEDS_SWITCH_MAX_WAIT) )
+        {
+            sLedsSwitchWait[stripIx]++;
+            sLedsNumDropped++;
+            return;
+        }
+        sLedsSwitchWait[stripIx] = 0;
+        sLedsSpiBufBusy[stripIx][0] = false;
+        sLedsSpiBufBusy[stripIx][1] = false;
+        if (sLedsPackWs2812[stripIx])
+        {
+            sLedsWs2812Start(stripIx);
+        }
+        else
+        {
+            sLedsWs2812Stop(stripIx);
+        }
+        sLedsWs2812Active[stripIx] = sLedsPackWs2812[stripIx];
+    }
+
+    // the previous buffer may still be being sent, the other one must be free (and the WS2812 output may
+    // not be able to queue it)
+    sLedsPollStrip(stripIx);
+    const int lastIx = sLedsSpiLastIx[stripIx];
+    const int bufIx = lastIx ^ 1;
+    if ( sLedsSpiBufBusy[stripIx][bufIx] || (sLedsWs2812Active[stripIx] && sLedsWs2812Busy(stripIx)) )
+    {
+        sLedsNumDropped++;
+        return;
+    }
+    uint8_t *pBuf = (uint8_t *)sLedsSpiBuf[stripIx][bufIx];
+
+    // copy framebuffer
+    if (sLedsPackFunc[stripIx] == NULL)
+    {
+        return;
+    }
+    LEDS_PROF_BEGIN(profPack);
+    const uint32_t t0 = micros();
+    const int nBytesToSend = sLedsPackFunc[stripIx](pBuf, sizeof(sLedsSpiBuf[stripIx][bufIx]), stripIx,
+        sLedsStripIx0(stripIx), sLedsStripNum(stripIx));
+    const uint32_t dtPack = micros() - t0;
+    LEDS_PROF_END(LEDS_PROF_PACK, profPack);
+    sLedsPackTimeSum[stripIx] += dtPack;
+    sLedsPackTimeNum[stripIx]++;
+    if (dtPack > sLedsPackTimeMax[stripIx])
+    {
+        sLedsPackTimeMax[stripIx] = dtPack;
+    }
+    //DEBUG("sLedsFlushStrip() %d %d", stripIx, nBytesToSend);
+    if (nBytesToSend <= 0)
+    {
+        return;
+    }
+
+    // skip if the strip already shows this
+    if ( !force && (nBytesToSend == sLedsSpiBufSize[stripIx][lastIx]) &&
+         ((sLedsNumFrames - sLedsSpiLastTick[stripIx]) < LEDS_REFRESH_TICKS) &&
+         (memcmp(pBuf, sLedsSpiBuf[stripIx][lastIx], nBytesToSend) == 0) )
+    {
+        return;
+    }
+    sLedsSpiBufSize[stripIx][bufIx] = nBytesToSend;
+    sLedsSpiLastIx[stripIx] = bufIx;
+    sLedsSpiLastTick[stripIx] = sLedsNumFrames;
+    sLedsNumFlushed++;
+
+    // send, and keep track of how long we're blocked by that
+    LEDS_PROF_BEGIN(profOut);
+    const uint32_t t1 = micros();
+    if (sLedsWs2812Active[stripIx])
+    {
+        sLedsWs2812Send(stripIx, bufIx);
+    }
+    else
+    {
+        sLedsSpiSend(stripIx, bufIx);
+    }
+    const uint32_t dt = micros() - t1;
+    LEDS_PROF_END(LEDS_PROF_OUT, profOut);
+    sLedsSpiWaitSum[stripIx] += dt;
+    sLedsSpiWaitNum[stripIx]++;
+    if (dt > sLedsSpiWaitMax[stripIx])
+    {
+        sLedsSpiWaitMax[stripIx] = dt;
+    }
+}
+
+// update LEDs on all strips, force = send even if nothing changed
+static void sLedsFlush(const bool force = true)
+{
+    for (int stripIx = 0; stripIx < LEDS_NUM_STRIPS; stripIx++)
+    {
+        sLedsFlushStrip(stripIx, force);
+    }
+}
+
+// time to re-send unchanged data (see LEDS_REFRESH_TICKS)
+static bool sLedsRefreshDue(void)
+{
+    for (int stripIx = 0; stripIx < LEDS_NUM_STRIPS; stripIx++)
+    {
+        if ((sLedsNumFrames - sLedsSpiLastTick[stripIx]) >= LEDS_REFRESH_TICKS)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+
+/* *********************************************************************************************** */
+
+// LED states (one per channel), as a structure of arrays with small types so that many LEDs fit (and the
+// render loop only touches what it needs)
+#define LEDS_NUM_CH CONFIG_NUM_CH
+static uint8_t sLedsHue[LEDS_NUM_CH];    // LEDS_PARAM_t.hue
+static uint8_t sLedsSat[LEDS_NUM_CH];    // LEDS_PARAM_t.sat
+static uint8_t sLedsVal[LEDS_NUM_CH];    // LEDS_PARAM_t.val
+static uint8_t sLedsFx[LEDS_NUM_CH];     // LEDS_PARAM_t.fx
+static int16_t sLedsArg[LEDS_NUM_CH];    // LEDS_PARAM_t.arg
+static uint16_t sLedsAnimT[LEDS_NUM_CH]; // animation time [ms] (or flicker countdown [ms])
+static uint8_t sLedsFxVal[LEDS_NUM_CH];  // flicker value
+static uint8_t sLedsFlags[LEDS_NUM_CH];  // LEDS_FLAG_...
+static uint8_t sLedsChRgb[LEDS_NUM_CH][3]; // rendered colour
+static uint16_t sLedsFadeT[LEDS_NUM_CH];    // crossfade time left [ms]
+static uint8_t sLedsFadeRgb[LEDS_NUM_CH][3]; // crossfading from this colour
+static uint8_t sLedsSpatial[LEDS_NUM_CH]; // spatial effect (LEDS_SPATIAL_t), NONE = same colour on all LEDs
+static uint8_t sLedsSpatPos[LEDS_NUM_CH]; // spatial effect head position on the path (0..255)
+
+#define LEDS_FLAG_INITED 0x01 // effect initialised
+#define LEDS_FLAG_RGB    0x02 // sLedsChRgb[] is up to date (for LEDS_FX_STILL, and not crossfading)
+#define LEDS_FLAG_BACK   0x04 // animation is playing backwards (LEDS_REPEAT_PINGPONG)
+
+// channel for each LED
+static uint8_t sLedsMap[LEDS_NUM];
+
+#define LEDS_MAP_NONE 0xff // LED is off
+
+#if (LEDS_NUM_CH >= LEDS_MAP_NONE)
+#  error too many channels for sLedsMap[]
+#endif
+
+// position of each LED on its channel's path (0..255 = once along), for the spatial effects
+static uint8_t sLedsPhase[LEDS_NUM];
+
+//! layout of a channel's LEDs
+typedef enum LEDS_LAYOUT_e
+{
+    LEDS_LAYOUT_LINE,   // "l", along the LEDs, then a gap (LEDS_LINE_SPAN) so that the head runs off the end
+    LEDS_LAYOUT_RING,   // "r", along the LEDs and back to the first one
+    LEDS_LAYOUT_MATRIX, // "m<w>", along the w columns, all LEDs in a column the same
+
+} LEDS_LAYOUT_t;
+
+#define LEDS_LINE_SPAN 192
+
+//! spatial effect, brightness along the channel's LEDs (see skLedsSpatialLut)
+typedef enum LEDS_SPATIAL_e
+{
+    LEDS_SPATIAL_NONE,  // same on all LEDs
+    LEDS_SPATIAL_BEAM,  // brightest at the head, dimmest opposite of it
+    LEDS_SPATIAL_CHASE, // four lit and four dark segments
+    LEDS_SPATIAL_COMET, // head with a tail fading over half the path
+    _LEDS_SPATIAL_NUM
+
+} LEDS_SPATIAL_t;
+
+// calculate sLedsPhase[] for sLedsMap[]
+static void sLedsPhaseCalc(const uint8_t *pkLayout, const uint16_t *pkWidth)
+{
+    uint16_t num[LEDS_NUM_CH];
+    uint16_t pos[LEDS_NUM_CH];
+    memset(num, 0, sizeof(num));
+    memset(pos, 0, sizeof(pos));
+    for (uint16_t ledIx = 0; ledIx < LEDS_NUM; ledIx++)
+    {
+        if (sLedsMap[ledIx] != LEDS_MAP_NONE)
+        {
+            num[ sLedsMap[ledIx] ]++;
+        }
+    }
+    for (uint16_t ledIx = 0; ledIx < LEDS_NUM; ledIx++)
+    {
+        const uint8_t chIx = sLedsMap[ledIx];
+        if (chIx == LEDS_MAP_NONE)
+        {
+            sLedsPhase[ledIx] = 0;
+            continue;
+        }
+        const uint32_t k = pos[chIx]++;
+        switch (pkLayout[chIx])
+        {
+            case LEDS_LAYOUT_RING:
+                sLedsPhase[ledIx] = k * 256 / num[chIx];
+                break;
+            case LEDS_LAYOUT_MATRIX:
+                sLedsPhase[ledIx] = (k % pkWidth[chIx]) * 256 / pkWidth[chIx];
+                break;
+            case LEDS_LAYOUT_LINE:
+            default:
+                sLedsPhase[ledIx] = k * LEDS_LINE_SPAN / num[chIx];
+                break;
+        }
+    }
+}
+
+// load channel to LEDs map (see ledsSetState()), NULL or "" = one LED per channel
+static bool sLedsMapLoad(const char *str)
+{
+    uint8_t map[LEDS_NUM];
+    uint8_t layout[LEDS_NUM_CH];
+    uint16_t width[LEDS_NUM_CH];
+    memset(layout, LEDS_LAYOUT_LINE, sizeof(layout));
+    memset(width, 0, sizeof(width));
+    if ( (str == NULL) || (str[0] == '\0') )
+    {
+        for (uint16_t ledIx = 0; ledIx < LEDS_NUM; ledIx++)
+        {
+            map[ledIx] = ledIx < LEDS_NUM_CH ? ledIx : LEDS_MAP_NONE;
+        }
+    }
+    else
+    {
+        memset(map, LEDS_MAP_NONE, sizeof(map));
+        int chIx = 0;
+        const char *pStr = str;
+        while (*pStr != '\0')
+        {
+            // no LEDs for this channel
+            if (*pStr == ';')
+            {
+                chIx++;
+                pStr++;
+                continue;
+            }
+            char *pEnd;
+            const long first = strtol(pStr, &pEnd, 10);
+            long last = first;
+            bool okay = pEnd != pStr;
+            if (okay && (*pEnd == '-'))
+            {
+                const char *pLast = &pEnd[1];
+                last = strtol(pLast, &pEnd, 10);
+                okay = pEnd != pLast;
+            }
+            if (okay && (chIx < LEDS_NUM_CH) && ((*pEnd == 'l') || (*pEnd == 'r') || (*pEnd == 'm')))
+            {
+                const char *pLayout = &pEnd[1];
+                switch (*pEnd)
+                {
+                    case 'l': layout[chIx] = LEDS_LAYOUT_LINE; pEnd++; break;
+                    case 'r': layout[chIx] = LEDS_LAYOUT_RING; pEnd++; break;
+                    case 'm':
+                        layout[chIx] = LEDS_LAYOUT_MATRIX;
+                        width[chIx] = strtol(pLayout, &pEnd, 10);
+                        okay = (pEnd != pLayout) && (width[chIx] > 0) && (width[chIx] <= LEDS_NUM);
+                        break;
+                }
+            }
+            if ( !okay || (first < 0) || (last < first) || (last >= LEDS_NUM) || (chIx >= LEDS_NUM_CH) ||
+                 ((*pEnd != ',') && (*pEnd != ';') && (*pEnd != '\0')) )
+            {
+                WARNING("leds: bad map at '%s'", pStr);
+                return false;
+            }
+            for (long ledIx = first; ledIx <= last; ledIx++)
+            {
+                map[ledIx] = chIx;
+            }
+            if (*pEnd == ';')
+            {
+                chIx++;
+            }
+            pStr = *pEnd != '\0' ? &pEnd[1] : pEnd;
+        }
+    }
+    memcpy(sLedsMap, map, sizeof(sLedsMap));
+    sLedsPhaseCalc(layout, width);
+    DEBUG("leds: map %s", str != NULL ? str : PSTR("(default)"));
+    return true;
+}
+
+// hue to colour mapping (cfgGetHues())
+static HSV2RGB_MODE_t sLedsHsvMode = HSV2RGB_MODE_CLASSIC;
+
+// some state changed (set by ledsSetState(), cleared by sLedsTask())
+static volatile bool sLedsStatesDirty;
+
+// time [ms] to crossfade from the old to the new colour on state change, 0 = switch immediately
+#ifndef CONFIG_LEDS_FADE_MS
+#  define CONFIG_LEDS_FADE_MS 300
+#endif
+
+void ledsSetState(const uint16_t chIx, const LEDS_PARAM_t *pkParam)
+{
+    if (chIx < LEDS_NUM_CH)
+    {
+        const int16_t arg = CLIP(pkParam->arg, -INT16_MAX, INT16_MAX);
+
+        // same as before, keep the effect running (and in phase)
+        if ( (sLedsHue[chIx] == pkParam->hue) && (sLedsSat[chIx] == pkParam->sat) && (sLedsVal[chIx] == pkParam->val) &&
+             (sLedsFx[chIx] == pkParam->fx) && (sLedsArg[chIx] == arg) )
+        {
+            return;
+        }
+
+        sLedsHue[chIx]   = pkParam->hue;
+        sLedsSat[chIx]   = pkParam->sat;
+        sLedsVal[chIx]   = pkParam->val;
+        sLedsFx[chIx]    = pkParam->fx;
+        sLedsArg[chIx]   = arg;
+        sLedsAnimT[chIx] = 0;
+        sLedsFxVal[chIx] = 0;
+        sLedsFlags[chIx] = 0;
+        sLedsSpatial[chIx] = LEDS_SPATIAL_NONE;
+#if (CONFIG_LEDS_FADE_MS > 0)
+        // from what is shown now (which may be halfway through another crossfade)
+        memcpy(sLedsFadeRgb[chIx], sLedsChRgb[chIx], sizeof(sLedsFadeRgb[chIx]));
+        sLedsFadeT[chIx] = CONFIG_LEDS_FADE_MS;
+#endif
+        sLedsStatesDirty = true;
+    }
+}
+
+/* *********************************************************************************************** */
+
+// The effects are described by (constant) animations: keyframe curves for the hue (offset), saturation and
+// value (scale of the channel's sat and val). Each curve is a list of keyframes at a position (fraction of
+// the period), with a value and the easing towards the next keyframe (or the first one, at the end of the
+// period). Everything is evaluated with integer math, the cost per channel and frame is bounded by the number
+// of keyframes (LEDS_ANIM_MAX_KEYS).
+
+//! easing from one keyframe to the next
+typedef enum LEDS_EASE_e
+{
+    LEDS_EASE_STEP,     // jump to the next value at the next keyframe
+    LEDS_EASE_LINEAR,   // linear
+    LEDS_EASE_SINE,     // sine in-out (slow at both ends)
+    LEDS_EASE_IN,       // quadratic, slow start
+    LEDS_EASE_OUT,      // quadratic, slow end
+
+} LEDS_EASE_t;
+
+//! repeat mode
+typedef enum LEDS_REPEAT_e
+{
+    LEDS_REPEAT_LOOP,     // start over
+    LEDS_REPEAT_PINGPONG, // play backwards, then start over
+    LEDS_REPEAT_ONCE,     // stop at the end
+
+} LEDS_REPEAT_t;
+
+//! meaning of the channel's LEDS_PARAM_t.arg
+typedef enum LEDS_ARG_e
+{
+    LEDS_ARG_NONE,      // unused
+    LEDS_ARG_PHASE,     // phase offset [argScale ms]
+    LEDS_ARG_PERIOD,    // period [argScale ms], negative = start half-way through
+
+} LEDS_ARG_t;
+
+//! keyframe
+typedef struct LEDS_KEY_s
+{
+    uint16_t pos;  // position in the period (0..65535 = 0..1)
+    uint8_t  val;  // hue offset, or sat/val scale (255 = 1.0)
+    uint8_t  ease; // LEDS_EASE_t towards the next keyframe
+
+} LEDS_KEY_t;
+
+#define LEDS_ANIM_MAX_KEYS 8
+
+
+//! animation
+typedef struct LEDS_ANIM_s
+{
+    uint16_t   period;   // [ms]
+    uint8_t    repeat;   // LEDS_REPEAT_t
+    uint8_t    arg;      // LEDS_ARG_t
+    uint16_t   argScale; // [ms]
+    uint8_t    flicker;  // use the candle flicker for the value (instead of the curve)
+    uint8_t    fps;      // frame rate [Hz] needed to render it smoothly, 0 = LEDS_FPS
+    uint8_t    spatial;  // LEDS_SPATIAL_t, the head moves along the LEDs once per period
+    uint8_t    numHue;   // number of keyframes for the hue, 0 = no offset
+    uint8_t    numSat;   // number of keyframes for the saturation, 0 = scale 1.0
+    uint8_t    numVal;   // number of keyframes for the value, 0 = scale 1.0
+    LEDS_KEY_t keys[LEDS_ANIM_MAX_KEYS]; // hue, then sat, then val keyframes
+
+} LEDS_ANIM_t;
+
+// the effects (LEDS_FX_t), from the old hand-written code: pulse = 2s sine between 10% and 100% with the
+// arg being the phase (in 10ms, ticks at the original 100 FPS), blink = on and off for 2 * arg ticks each;
+// the pulse is slow enough for 50 FPS, the flicker and the blink edges want every tick; the spatial effects
+// are rendered once per channel, and looked up for each LED (by its sLedsPhase[]) when fanning out
+static const LEDS_ANIM_t skLedsAnims[] PROGMEM =
+{
+    // LEDS_FX_STILL
+    { .period = 1000, .repeat = LEDS_REPEAT_ONCE, .arg = LEDS_ARG_NONE, .argScale = 0, .flicker = 0, .fps = 1,
+      .spatial = LEDS_SPATIAL_NONE, .numHue = 0, .numSat = 0, .numVal = 0, .keys = { } },
+    // LEDS_FX_PULSE
+    { .period = 2010, .repeat = LEDS_REPEAT_LOOP, .arg = LEDS_ARG_PHASE, .argScale = 10, .flicker = 0, .fps = 50,
+      .spatial = LEDS_SPATIAL_NONE, .numHue = 0, .numSat = 0, .numVal = 2,
+      .keys = { { 0, 26, LEDS_EASE_SINE }, { 32768, 255, LEDS_EASE_SINE } } },
+    // LEDS_FX_FLICKER
+    { .period = 1000, .repeat = LEDS_REPEAT_LOOP, .arg = LEDS_ARG_NONE, .argScale = 0, .flicker = 1, .fps = 0,
+      .spatial = LEDS_SPATIAL_NONE, .numHue = 0, .numSat = 0, .numVal = 0, .keys = { } },
+    // LEDS_FX_BLINK
+    { .period = 0, .repeat = LEDS_REPEAT_LOOP, .arg = LEDS_ARG_PERIOD, .argScale = 40, .flicker = 0, .fps = 0,
+      .spatial = LEDS_SPATIAL_NONE, .numHue = 0, .numSat = 0, .numVal = 2,
+      .keys = { { 0, 255, LEDS_EASE_STEP }, { 32768, 0, LEDS_EASE_STEP } } },
+    // LEDS_FX_ROTATE
+    { .period = 2010, .repeat = LEDS_REPEAT_LOOP, .arg = LEDS_ARG_PHASE, .argScale = 10, .flicker = 0, .fps = 50,
+      .spatial = LEDS_SPATIAL_BEAM, .numHue = 0, .numSat = 0, .numVal = 0, .keys = { } },
+    // LEDS_FX_CHASE
+    { .period = 2000, .repeat = LEDS_REPEAT_LOOP, .arg = LEDS_ARG_PHASE, .argScale = 10, .flicker = 0, .fps = 50,
+      .spatial = LEDS_SPATIAL_CHASE, .numHue = 0, .numSat = 0, .numVal = 0, .keys = { } },
+    // LEDS_FX_COMET
+    { .period = 1500, .repeat = LEDS_REPEAT_LOOP, .arg = LEDS_ARG_PHASE, .argScale = 10, .flicker = 0, .fps = 50,
+      .spatial = LEDS_SPATIAL_COMET, .numHue = 0, .numSat = 0, .numVal = 0, .keys = { } },
+};
+
+// easing, u = 0..256 (position between two keyframes), returns 0..256
+static const uint8_t skLedsEaseSine[33] PROGMEM = // round(255 * (1 - cos(pi * (0:32) / 32)) / 2)
+{
+      0,   1,   2,   5,  10,  15,  21,  29,  37,  47,  57,  67,  79,  90, 103, 115, 127,
+    140, 152, 165, 176, 188, 198, 208, 218, 226, 234, 240, 245, 250, 253, 254, 255
+};
+
+static inline uint32_t sLedsEase(const uint8_t ease, const uint32_t u)
+{
+    switch (ease)
+    {
+        case LEDS_EASE_STEP:
+            return 0;
+        case LEDS_EASE_LINEAR:
+            return u;
+        case LEDS_EASE_SINE:
+        {
+            const uint32_t ix = u >> 3;
+            if (ix >= (NUMOF(skLedsEaseSine) - 1))
+            {
+                return 256;
+            }
+            const uint32_t e0 = pgm_read_byte(&skLedsEaseSine[ix]);
+            const uint32_t e1 = pgm_read_byte(&skLedsEaseSine[ix + 1]);
+            return ((e0 << 3) + ((e1 - e0) * (u & 0x7))) * 256 / (255 << 3);
+        }
+        case LEDS_EASE_IN:
+            return (u * u) >> 8;
+        case LEDS_EASE_OUT:
+            return 256 - (((256 - u) * (256 - u)) >> 8);
+    }
+    return u;
+}
+
+// evaluate curve at position pos (0..65535)
+static uint8_t sLedsCurve(const LEDS_KEY_t *pkKeys, const int num, const uint32_t pos)
+{
+    // find keyframe before pos, and the next one (wrapping to the first at the end of the period)
+    int ix = num - 1;
+    while ( (ix > 0) && (pkKeys[ix].pos > pos) )
+    {
+        ix--;
+    }
+    const LEDS_KEY_t *pkKey0 = &pkKeys[ix];
+    const LEDS_KEY_t *pkKey1 = &pkKeys[ (ix + 1) < num ? (ix + 1) : 0 ];
+    const uint32_t pos0 = pkKey0->pos;
+    const uint32_t pos1 = (ix + 1) < num ? pkKey1->pos : 65536;
+    if ( (pos1 <= pos0) || (pos < pos0) )
+    {
+        return pkKey0->val;
+    }
+    const uint32_t u = ((pos - pos0) << 8) / (pos1 - pos0);
+    const int32_t  e = sLedsEase(pkKey0->ease, u);
+    return (int32_t)pkKey0->val + ((((int32_t)pkKey1->val - (int32_t)pkKey0->val) * e) >> 8);
+}
+
+// scale value (0..255) by s (0..255 = 0.0..1.0)
+static inline uint8_t sLedsScale(const uint8_t val, const uint8_t s)
+{
+    return ((uint32_t)val * ((uint32_t)s + 1)) >> 8;
+}
+
+// the spatial effects as lookup tables, indexed by the distance behind the head (0..255 = once along the path),
+// see tools/ledsim (-L) for how they're made
+static const uint8_t skLedsSpatialLut[_LEDS_SPATIAL_NUM - 1][256] PROGMEM =
+{
+    // LEDS_SPATIAL_BEAM: same curve as the pulse (so that a ring of LEDs with LEDS_FX_ROTATE looks like the
+    // Hello lighthouse), i.e. sLedsCurve({ { 0, 255, LEDS_EASE_SINE }, { 32768, 26, LEDS_EASE_SINE } }, d << 8)
+    {
+        255, 255, 255, 255, 254, 254, 254, 254, 253, 253, 252, 251, 250, 249, 248, 247,
+        246, 245, 244, 243, 241, 240, 238, 238, 236, 234, 232, 230, 229, 227, 225, 223,
+        221, 220, 217, 215, 212, 211, 208, 206, 204, 202, 199, 197, 195, 192, 189, 187,
+        184, 181, 179, 177, 174, 171, 169, 165, 162, 160, 157, 154, 152, 149, 146, 144,
+        141, 138, 135, 132, 129, 127, 124, 121, 119, 116, 112, 110, 107, 104, 102, 100,
+         97,  94,  92,  89,  86,  84,  82,  79,  77,  75,  73,  70,  68,  66,  64,  61,
+         59,  58,  56,  54,  52,  51,  49,  47,  45,  43,  42,  41,  40,  38,  37,  36,
+         35,  34,  33,  32,  31,  30,  29,  28,  28,  27,  27,  27,  27,  26,  26,  26,
+         26,  26,  26,  26,  26,  26,  26,  26,  27,  27,  28,  29,  30,  31,  32,  33,
+         34,  35,  36,  37,  39,  40,  42,  42,  44,  46,  48,  50,  51,  53,  55,  57,
+         59,  60,  63,  65,  68,  69,  72,  74,  76,  78,  81,  83,  85,  88,  91,  93,
+         96,  99, 101, 103, 106, 109, 111, 115, 118, 120, 123, 126, 128, 131, 134, 136,
+        139, 142, 145, 148, 151, 153, 156, 159, 161, 164, 168, 170, 173, 176, 178, 180,
+        183, 186, 188, 191, 194, 196, 198, 201, 203, 205, 207, 210, 212, 214, 216, 219,
+        221, 222, 224, 226, 228, 229, 231, 233, 235, 237, 238, 239, 240, 242, 243, 244,
+        245, 246, 247, 248, 249, 250, 251, 252, 252, 253, 253, 253, 253, 254, 254, 254
+    },
+    // LEDS_SPATIAL_CHASE: (d & 0x3f) < 0x20 ? 255 : 0
+    {
+        255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255,
+        255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255,
+          0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+          0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+        255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255,
+        255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255,
+          0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+          0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+        255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255,
+        255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255,
+          0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+          0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+        255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255,
+        255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255, 255,
+          0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+          0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0
+    },
+    // LEDS_SPATIAL_COMET: d < 128 ? (255 * sLedsEase(LEDS_EASE_IN, (128 - d) * 2)) >> 8 : 0
+    {
+        255, 251, 247, 243, 239, 235, 231, 227, 224, 220, 216, 212, 209, 205, 202, 198,
+        195, 191, 188, 184, 181, 177, 174, 171, 168, 164, 161, 158, 155, 152, 149, 146,
+        143, 140, 137, 134, 131, 128, 125, 122, 120, 117, 114, 111, 109, 106, 104, 101,
+         99,  96,  94,  91,  89,  86,  84,  82,  80,  77,  75,  73,  71,  69,  67,  65,
+         63,  61,  59,  57,  55,  53,  51,  49,  48,  46,  44,  42,  41,  39,  38,  36,
+         35,  33,  32,  30,  29,  27,  26,  25,  24,  22,  21,  20,  19,  18,  17,  16,
+         15,  14,  13,  12,  11,  10,   9,   8,   8,   7,   6,   5,   5,   4,   4,   3,
+          3,   2,   2,   1,   1,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+          0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+          0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+          0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+          0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+          0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+          0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+          0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+          0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0
+    },
+};
+
+// candle flicker: probabilites by "Eric", commented on
+// https://cpldcpu.wordpress.com/2016/01/05/reverse-engineering-a-real-candle/#comment-1809
+typedef struct LEDS_FLICKER_DIST_s
+{
+    uint8_t percent; // probability
+    uint8_t min;     // range of values..
+    uint8_t max;     // ..(excluding max)
+} LEDS_FLICKER_DIST_t;
+
+// Probability  Random LED Brightness                               value 0..255
+//  50%          77% -  80% (its barely noticeable)                 196..204
+//  30%          80% - 100% (very noticeable, sim. air flicker)     204..255
+//   5%          50% -  80% (very noticeable, blown out flame)      128..204
+//   5%          40% -  50% (very noticeable, blown out flame)      102..128
+//  10%          30% -  40% (very noticeable, blown out flame)       77..102
+static const LEDS_FLICKER_DIST_t skLedsFlickerVal[] =
+{
+    { 50, 196, 204 }, { 30, 204, 255 }, { 5, 128, 204 }, { 5, 102, 128 }, { 10, 77, 102 },
+};
+
+// Probability  Random Time (Duration)
+//  90%          20 ms
+//   3%          20 - 30 ms
+//   3%          10 - 20 ms
+//   4%           0 - 10 ms
+// (the durations are doubled, that's how it has always been, and the ranges don't overlap)
+static const LEDS_FLICKER_DIST_t skLedsFlickerDur[] =
+{
+    { 90, 2 * 20, 2 * 20 + 1 }, { 3, 2 * 20 + 1, 2 * 30 }, { 3, 2 * 10, 2 * 20 }, { 4, 0, 2 * 10 },
+};
+
+// the distributions as lookup tables, indexed by a random byte (see tools/ledsim (-L) for how they're made)
+static const uint8_t skLedsFlickerValLut[256] PROGMEM =
+{
+    196, 196, 196, 196, 196, 196, 196, 196, 196, 196, 196, 196, 196, 196, 196, 196,
+    197, 197, 197, 197, 197, 197, 197, 197, 197, 197, 197, 197, 197, 197, 197, 197,
+    198, 198, 198, 198, 198, 198, 198, 198, 198, 198, 198, 198, 198, 198, 198, 198,
+    199, 199, 199, 199, 199, 199, 199, 199, 199, 199, 199, 199, 199, 199, 199, 199,
+    200, 200, 200, 200, 200, 200, 200, 200, 200, 200, 200, 200, 200, 200, 200, 200,
+    201, 201, 201, 201, 201, 201, 201, 201, 201, 201, 201, 201, 201, 201, 201, 201,
+    202, 202, 202, 202, 202, 202, 202, 202, 202, 202, 202, 202, 202, 202, 202, 202,
+    203, 203, 203, 203, 203, 203, 203, 203, 203, 203, 203, 203, 203, 203, 203, 203,
+    204, 204, 205, 205, 206, 207, 207, 208, 209, 209, 210, 211, 211, 212, 213, 213,
+    214, 215, 215, 216, 217, 217, 218, 219, 219, 220, 221, 221, 222, 223, 223, 224,
+    225, 225, 226, 227, 227, 228, 229, 229, 230, 231, 231, 232, 233, 233, 234, 235,
+    235, 236, 237, 237, 238, 239, 239, 240, 241, 241, 242, 243, 243, 244, 245, 245,
+    246, 247, 247, 248, 249, 249, 250, 251, 251, 252, 253, 253, 254, 128, 133, 139,
+    145, 151, 157, 163, 168, 174, 180, 186, 192, 198, 102, 104, 106, 108, 110, 112,
+    115, 117, 119, 121, 123, 125,  77,  77,  78,  79,  80,  81,  82,  83,  84,  85,
+     86,  87,  88,  89,  90,  91,  92,  93,  94,  95,  96,  97,  98,  99, 100, 101
+};
+static const uint8_t skLedsFlickerDurLut[256] PROGMEM =
+{
+     40,  40,  40,  40,  40,  40,  40,  40,  40,  40,  40,  40,  40,  40,  40,  40,
+     40,  40,  40,  40,  40,  40,  40,  40,  40,  40,  40,  40,  40,  40,  40,  40,
+     40,  40,  40,  40,  40,  40,  40,  40,  40,  40,  40,  40,  40,  40,  40,  40,
+     40,  40,  40,  40,  40,  40,  40,  40,  40,  40,  40,  40,  40,  40,  40,  40,
+     40,  40,  40,  40,  40,  40,  40,  40,  40,  40,  40,  40,  40,  40,  40,  40,
+     40,  40,  40,  40,  40,  40,  40,  40,  40,  40,  40,  40,  40,  40,  40,  40,
+     40,  40,  40,  40,  40,  40,  40,  40,  40,  40,  40,  40,  40,  40,  40,  40,
+     40,  40,  40,  40,  40,  40,  40,  40,  40,  40,  40,  40,  40,  40,  40,  40,
+     40,  40,  40,  40,  40,  40,  40,  40,  40,  40,  40,  40,  40,  40,  40,  40,
+     40,  40,  40,  40,  40,  40,  40,  40,  40,  40,  40,  40,  40,  40,  40,  40,
+     40,  40,  40,  40,  40,  40,  40,  40,  40,  40,  40,  40,  40,  40,  40,  40,
+     40,  40,  40,  40,  40,  40,  40,  40,  40,  40,  40,  40,  40,  40,  40,  40,
+     40,  40,  40,  40,  40,  40,  40,  40,  40,  40,  40,  40,  40,  40,  40,  40,
+     40,  40,  40,  40,  40,  40,  40,  40,  40,  40,  40,  40,  40,  40,  40,  40,
+     40,  40,  40,  40,  40,  40,  41,  43,  45,  48,  50,  52,  55,  57,  20,  22,
+     25,  27,  30,  32,  35,  37,   0,   2,   4,   6,   8,  10,  12,  14,  16,  18
+};
+
+// random number generator state for each channel (xorshift32)
+static uint32_t sLedsRand[LEDS_NUM_CH];
+
+// seed for the random number generators
+#ifndef CONFIG_LEDS_SEED
+#  define CONFIG_LEDS_SEED 0x2545f491
+#endif
+
+static void sLedsRandSeed(const uint32_t seed)
+{
+    for (uint16_t chIx = 0; chIx < LEDS_NUM_CH; chIx++)
+    {
+        // any state but 0
+        sLedsRand[chIx] = (seed ^ ((uint32_t)(chIx + 1) * 0x9e3779b9)) | 0x1;
+    }
+}
+
+static inline uint32_t sLedsRandNext(const uint16_t chIx)
+{
+    uint32_t x = sLedsRand[chIx];
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    sLedsRand[chIx] = x;
+    return x;
+}
+
+// candle flicker, returns the value scale
+static uint8_t sLedsFlicker(const uint16_t chIx, const uint32_t dt)
+{
+    if (sLedsAnimT[chIx] <= dt)
+    {
+        const uint32_t r = sLedsRandNext(chIx);
+        sLedsFxVal[chIx] = pgm_read_byte(&skLedsFlickerValLut[r & 0xff]);
+        sLedsAnimT[chIx] = pgm_read_byte(&skLedsFlickerDurLut[(r >> 8) & 0xff]);
+    }
+    else
+    {
+        sLedsAnimT[chIx] -= dt;
+    }
+    return sLedsFxVal[chIx];
+}
+
+// render channel's animation, advance by dt [ms], returns the frame rate [Hz] it needs
+static uint16_t sLedsRenderFx(const uint16_t chIx, const uint32_t dt, uint8_t *pHue, uint8_t *pSat, uint8_t *pVal)
+{
+    LEDS_ANIM_t anim;
+    const uint8_t fx = sLedsFx[chIx] < NUMOF(skLedsAnims) ? sLedsFx[chIx] : (uint8_t)LEDS_FX_STILL;
+    memcpy_P(&anim, &skLedsAnims[fx], sizeof(anim));
+
+    // period, and start with the phase (a negative period starts half-way through, e.g. in the blink's off phase)
+    uint32_t period = anim.period;
+    const int32_t arg = sLedsArg[chIx];
+    if (anim.arg == LEDS_ARG_PERIOD)
+    {
+        period = (uint32_t)ABS(arg) * anim.argScale;
+    }
+    period = CLIP(period, 1, 65535);
+    if ((sLedsFlags[chIx] & LEDS_FLAG_INITED) == 0)
+    {
+        switch (anim.arg)
+        {
+            case LEDS_ARG_PHASE:  sLedsAnimT[chIx] = (uint32_t)ABS(arg) * anim.argScale % period; break;
+            case LEDS_ARG_PERIOD: sLedsAnimT[chIx] = arg < 0 ? period / 2 : 0;                    break;
+            default:              sLedsAnimT[chIx] = 0;                                           break;
+        }
+        sLedsFlags[chIx] |= LEDS_FLAG_INITED;
+    }
+
+    uint8_t hue = sLedsHue[chIx];
+    uint8_t sat = sLedsSat[chIx];
+    uint8_t val = sLedsVal[chIx];
+
+    if (anim.flicker)
+    {
+        val = sLedsScale(val, sLedsFlicker(chIx, dt));
+    }
+    else
+    {
+        // position in the period
+        const uint32_t t = sLedsAnimT[chIx];
+        const bool back = (sLedsFlags[chIx] & LEDS_FLAG_BACK) != 0;
+        const uint32_t pos = MIN( ((back ? (period - t) : t) << 16) / period, 65535 );
+        sLedsSpatial[chIx] = anim.spatial;
+        sLedsSpatPos[chIx] = pos >> 8;
+
+        const LEDS_KEY_t *pkKeys = anim.keys;
+        if (anim.numHue > 0)
+        {
+            hue += sLedsCurve(pkKeys, anim.numHue, pos);
+            pkKeys += anim.numHue;
+        }
+        if (anim.numSat > 0)
+        {
+            sat = sLedsScale(sat, sLedsCurve(pkKeys, anim.numSat, pos));
+            pkKeys += anim.numSat;
+        }
+        if (anim.numVal > 0)
+        {
+            val = sLedsScale(val, sLedsCurve(pkKeys, anim.numVal, pos));
+        }
+
+        // advance
+        uint32_t tNext = t + dt;
+        if (tNext >= period)
+        {
+            switch (anim.repeat)
+            {
+                case LEDS_REPEAT_LOOP:
+                    tNext %= period;
+                    break;
+                case LEDS_REPEAT_PINGPONG:
+                    // a late frame may have crossed more than one turn
+                    if (((tNext / period) & 0x1) != 0)
+                    {
+                        sLedsFlags[chIx] ^= LEDS_FLAG_BACK;
+                    }
+                    tNext %= period;
+                    break;
+                case LEDS_REPEAT_ONCE:
+                    tNext = period;
+                    break;
+            }
+        }
+        sLedsAnimT[chIx] = tNext;
+    }
+
+    *pHue = hue;
+    *pSat = sat;
+    *pVal = val;
+
+    return anim.fps > 0 ? anim.fps : LEDS_FPS;
+}
+
+#if (CONFIG_LEDS_PROFILE > 0)
+// [cycles] available per frame
+#  define LEDS_PROF_BUDGET (sLedsProfMhz * (1000000 / LEDS_FPS))
+
+// add the current frame (that started at mhz) to the profile
+static void sLedsProfFrame(const uint32_t mhz)
+{
+    // CPU frequency changed during the frame (cpuBoost()), we can't tell the time it took
+    if (mhz != ESP.getCpuFreqMHz())
+    {
+        return;
+    }
+    // CPU frequency changed since the previous frames, start over
+    if ( (sLedsProfNum > 0) && (mhz != sLedsProfMhz) )
+    {
+        sLedsProfNum = 0;
+    }
+    if (sLedsProfNum == 0)
+    {
+        sLedsProfMhz = mhz;
+        memset(sLedsProfCycSum, 0, sizeof(sLedsProfCycSum));
+        memset(sLedsProfCycMin, 0xff, sizeof(sLedsProfCycMin));
+        memset(sLedsProfCycMax, 0, sizeof(sLedsProfCycMax));
+        sLedsProfOver = 0;
+    }
+    for (int ix = 0; ix < _LEDS_PROF_NUM; ix++)
+    {
+        const uint32_t cyc = sLedsProfCyc[ix];
+        sLedsProfCycSum[ix] += cyc;
+        if (cyc < sLedsProfCycMin[ix])
+        {
+            sLedsProfCycMin[ix] = cyc;
+        }
+        if (cyc > sLedsProfCycMax[ix])
+        {
+            sLedsProfCycMax[ix] = cyc;
+        }
+    }
+    if (sLedsProfCyc[LEDS_PROF_TASK] > LEDS_PROF_BUDGET)
+    {
+        sLedsProfOver++;
+    }
+    sLedsProfNum++;
+}
+
+// print the profile (since the last time), and start over, optionally also summarise it into the report string
+static void sLedsProfPrint(const char *prefix, char *report, const int size)
+{
+    if (sLedsProfNum == 0)
+    {
+        DEBUG("%sleds: prof no frames", prefix);
+        if (report != NULL)
+        {
+            snprintf_P(report, size, PSTR("frames:0"));
+        }
+        return;
+    }
+    const uint32_t mhz = sLedsProfMhz;
+    const uint32_t budget = LEDS_PROF_BUDGET;
+    int len = 0;
+    for (int ix = 0; ix < _LEDS_PROF_NUM; ix++)
+    {
+        const uint32_t avg = sLedsProfCycSum[ix] / sLedsProfNum;
+        const uint32_t permille = (uint64_t)avg * 1000 / budget;
+        DEBUG("%sleds: prof %-4s min=%u avg=%u max=%u [us/frame] (%u/%u/%u cycles, avg %u.%u%% of frame)",
+            prefix, skLedsProfNames[ix], sLedsProfCycMin[ix] / mhz, avg / mhz, sLedsProfCycMax[ix] / mhz,
+            sLedsProfCycMin[ix], avg, sLedsProfCycMax[ix], permille / 10, permille % 10);
+        // "<stage>:<avg>/<max>," [us/frame]
+        if ( (report != NULL) && (len < size) )
+        {
+            len += snprintf_P(&report[len], size - len, PSTR("%s:%u/%u,"),
+                skLedsProfNames[ix], avg / mhz, sLedsProfCycMax[ix] / mhz);
+        }
+    }
+    DEBUG("%sleds: prof frames=%u over=%u budget=%u [us/frame] (%u MHz)",
+        prefix, sLedsProfNum, sLedsProfOver, budget / mhz, mhz);
+    if ( (report != NULL) && (len < size) )
+    {
+        snprintf_P(&report[len], size - len, PSTR("frames:%u,over:%u,budget:%u@%uMHz"),
+            sLedsProfNum, sLedsProfOver, budget / mhz, mhz);
+    }
+    sLedsProfNum = 0;
+}
+#endif // (CONFIG_LEDS_PROFILE > 0)
+
+#if (CONFIG_LEDS_FADE_MS > 0)
+// crossfade the rendered colour from the previous colour, advance by dt [ms]
+static void sLedsFade(const uint16_t chIx, const uint32_t dt)
+{
+    // weight of the old colour (0..256)
+    const uint16_t w = ((uint32_t)sLedsFadeT[chIx] << 8) / CONFIG_LEDS_FADE_MS;
+    uint8_t *pRgb = sLedsChRgb[chIx];
+    const uint8_t *pkFrom = sLedsFadeRgb[chIx];
+    pRgb[_R_] = (((uint16_t)pkFrom[_R_] * w) + ((uint16_t)pRgb[_R_] * (256 - w))) >> 8;
+    pRgb[_G_] = (((uint16_t)pkFrom[_G_] * w) + ((uint16_t)pRgb[_G_] * (256 - w))) >> 8;
+    pRgb[_B_] = (((uint16_t)pkFrom[_B_] * w) + ((uint16_t)pRgb[_B_] * (256 - w))) >> 8;
+    sLedsFadeT[chIx] = sLedsFadeT[chIx] > dt ? sLedsFadeT[chIx] - dt : 0;
+    // blended in place, so convert the still colour again next time
+    sLedsFlags[chIx] &= ~LEDS_FLAG_RGB;
+}
+#endif
+
+// advance the animation clock, returns the time [ms] elapsed since the last tick
+static uint32_t sLedsClockTick(void)
+{
+    const uint32_t now = micros();
+    if (sLedsClockLast == 0)
+    {
+        sLedsClockLast = now;
+        return 1000 / LEDS_FPS;
+    }
+    const uint32_t dt = now - sLedsClockLast;
+    sLedsClockLast = now;
+
+    // jitter statistics
+    const uint32_t dtMs = dt / 1000;
+    uint16_t binIx = 0;
+    while ( (binIx < NUMOF(skLedsClockHistBins)) && (dtMs >= skLedsClockHistBins[binIx]) )
+    {
+        binIx++;
+    }
+    sLedsClockHist[binIx]++;
+    if (dt > sLedsClockMax)
+    {
+        sLedsClockMax = dt;
+    }
+    if (dt > (LEDS_TICK_US + (LEDS_TICK_US / 2)))
+    {
+        sLedsClockLate++;
+        sLedsClockMissed += ((dt + (LEDS_TICK_US / 2)) / LEDS_TICK_US) - 1;
+    }
+
+    // hand out whole milliseconds, keep the rest for the next tick
+    sLedsClockRem += dt;
+    uint32_t res = sLedsClockRem / 1000;
+    sLedsClockRem -= res * 1000;
+    if (res > LEDS_CLOCK_MAX_DT)
+    {
+        res = LEDS_CLOCK_MAX_DT;
+    }
+    return res;
+}
+
+static void sLedsTask(void)
+{
+    static CFG_DRIVER_t sConfigDriverLast[LEDS_NUM_STRIPS]; // CFG_DRIVER_UNKNOWN
+    static CFG_ORDER_t  sConfigOrderLast[LEDS_NUM_STRIPS];  // CFG_ORDER_UNKNOWN
+    static CFG_BRIGHT_t sConfigBrightLast = CFG_BRIGHT_UNKNOWN;
+    static uint32_t     sConfigLedsGenLast = 0;
+    static CFG_HUES_t   sConfigHuesLast   = CFG_HUES_UNKNOWN;
+
+    //while (true)
+    {
+#if (CONFIG_LEDS_PROFILE > 0)
+        const uint32_t profMhz = ESP.getCpuFreqMHz();
+#endif
+        LEDS_PROF_BEGIN(profTask);
+        CFG_DRIVER_t configDriver[LEDS_NUM_STRIPS];
+        CFG_ORDER_t  configOrder[LEDS_NUM_STRIPS];
+        configDriver[0] = cfgGetDriver();
+        configOrder[0]  = cfgGetOrder();
+#if (LEDS_NUM_STRIPS > 1)
+        configDriver[1] = cfgGetDriver2();
+        configOrder[1]  = cfgGetOrder2();
+#endif
+        const CFG_BRIGHT_t configBright = cfgGetBright();
+        const uint32_t     configLedsGen = cfgGetLedsGen();
+        const CFG_HUES_t   configHues   = cfgGetHues();
+        const uint32_t     dt = sLedsClockTick();
+
+        // handle config changes
+        bool configChanged = false;
+        bool driverChanged = false;
+        bool orderChanged = false;
+        bool driverKnown = false;
+        for (int stripIx = 0; stripIx < LEDS_NUM_STRIPS; stripIx++)
+        {
+            driverChanged = driverChanged || (sConfigDriverLast[stripIx] != configDriver[stripIx]);
+            orderChanged  = orderChanged  || (sConfigOrderLast[stripIx]  != configOrder[stripIx]);
+            driverKnown   = driverKnown   || (configDriver[stripIx] != CFG_DRIVER_UNKNOWN);
+        }
+        if (driverChanged)
+        {
+            DEBUG("leds: driver change");
+            sLedsClear();
+            sLedsFlush(); // using the previous drivers' packers
+            for (int stripIx = 0; stripIx < LEDS_NUM_STRIPS; stripIx++)
+            {
+                sConfigDriverLast[stripIx] = configDriver[stripIx];
+                // timing statistics per driver
+                sLedsSpiWaitSum[stripIx]  = 0;
+                sLedsSpiWaitMax[stripIx]  = 0;
+                sLedsSpiWaitNum[stripIx]  = 0;
+                sLedsPackTimeSum[stripIx] = 0;
+                sLedsPackTimeMax[stripIx] = 0;
+                sLedsPackTimeNum[stripIx] = 0;
+            }
+            configChanged = true;
+        }
+        if (orderChanged)
+        {
+            DEBUG("leds: order change");
+            for (int stripIx = 0; stripIx < LEDS_NUM_STRIPS; stripIx++)
+            {
+                sConfigOrderLast[stripIx] = configOrder[stripIx];
+            }
+            configChanged = true;
+        }
+        if (sConfigBrightLast != configBright)
+        {
+            DEBUG("leds: bright change");
+            sConfigBrightLast = configBright;
+            configChanged = true;
+        }
+        if (sConfigLedsGenLast != configLedsGen)
+        {
+            DEBUG("leds: map change");
+            sLedsMapLoad(cfgGetLeds());
+            sConfigLedsGenLast = configLedsGen;
+            configChanged = true;
+        }
+        if (sConfigHuesLast != configHues)
+        {
+            DEBUG("leds: hues change");
+            sLedsHsvMode = configHues == CFG_HUES_RAINBOW ? HSV2RGB_MODE_RAINBOW : HSV2RGB_MODE_CLASSIC;
+            // convert the still colours again
+            for (uint16_t chIx = 0; chIx < LEDS_NUM_CH; chIx++)
+            {
+                sLedsFlags[chIx] &= ~LEDS_FLAG_RGB;
+            }
+            sConfigHuesLast = configHues;
+            configChanged = true;
+        }
+        if (configChanged)
+        {
+            for (int stripIx = 0; stripIx < LEDS_NUM_STRIPS; stripIx++)
+            {
+                sLedsPackSelect(stripIx, configDriver[stripIx], configOrder[stripIx], configBright);
+            }
+        }
+
+        // cannot do much if we don't know the driver
+        if (!driverKnown)
+        {
+            return;
+        }
+
+        // nothing is animating and nothing has changed, the strip shows the right thing already
+        sLedsNumFrames++;
+        static bool sAnimating = true;
+        static bool sSettled = true;
+        if (!sAnimating && !sLedsStatesDirty && !configChanged)
+        {
+            // ..but replace the (dithered) last changes by the rounded values that the refresh sends..
+            if (!sSettled)
+            {
+                sLedsFlush(false);
+                sSettled = true;
+            }
+            // ..and refresh every once in a while (or until the new output peripheral has taken over)
+            else if (sLedsRefreshDue() || sLedsSwitchPending())
+            {
+                sLedsFlush();
+            }
+            sLedsTickAcc = 0;
+            return;
+        }
+
+        // slow effects only, skip some ticks (unless something changed)
+        sLedsTickAcc += dt;
+        sLedsTickCnt++;
+        if (!sLedsStatesDirty && !configChanged && (sLedsTickCnt < sLedsTickDiv))
+        {
+            return;
+        }
+        const uint32_t frameDt = MIN(sLedsTickAcc, LEDS_CLOCK_MAX_DT);
+        sLedsTickDivHist[ sLedsTickCnt < 3 ? sLedsTickCnt - 1 : (sLedsTickCnt < 5 ? 2 : 3) ]++;
+        sLedsTickAcc = 0;
+        sLedsTickCnt = 0;
+        sLedsStatesDirty = false;
+
+        // render next frame..
+        sLedsNumRendered++;
+#if (CONFIG_LEDS_PROFILE > 0)
+        memset(sLedsProfCyc, 0, sizeof(sLedsProfCyc));
+#endif
+        const uint32_t t0 = micros();
+        bool animating = false;
+        uint16_t fps = 0; // frame rate [Hz] needed by the effects
+        // ..collect the colours that need converting..
+        static uint8_t sH[LEDS_NUM_CH];
+        static uint8_t sS[LEDS_NUM_CH];
+        static uint8_t sV[LEDS_NUM_CH];
+        static uint8_t sChIx[LEDS_NUM_CH];
+        static uint8_t sRgb[LEDS_NUM_CH][3];
+        int numConv = 0;
+        LEDS_PROF_BEGIN(profFx);
+        for (uint16_t chIx = 0; chIx < LEDS_NUM_CH; chIx++)
+        {
+            if (sLedsFx[chIx] == LEDS_FX_STILL)
+            {
+                // convert once, LEDs stay still most of the time
+                if ((sLedsFlags[chIx] & LEDS_FLAG_RGB) == 0)
+                {
+                    sH[numConv] = sLedsHue[chIx];
+                    sS[numConv] = sLedsSat[chIx];
+                    sV[numConv] = sLedsVal[chIx];
+                    sChIx[numConv++] = chIx;
+                    sLedsFlags[chIx] |= LEDS_FLAG_RGB;
+                }
+            }
+            else
+            {
+                const uint16_t fxFps = sLedsRenderFx(chIx, frameDt, &sH[numConv], &sS[numConv], &sV[numConv]);
+                fps = MAX(fps, fxFps);
+                sChIx[numConv++] = chIx;
+                animating = true;
+            }
+        }
+        LEDS_PROF_END(LEDS_PROF_FX, profFx);
+
+        // ..convert them all at once..
+        LEDS_PROF_BEGIN(profHsv);
+        hsv2rgbMany(sH, sS, sV, &sRgb[0][0], numConv, sLedsHsvMode);
+        for (int ix = 0; ix < numConv; ix++)
+        {
+            uint8_t *pRgb = sLedsChRgb[sChIx[ix]];
+            pRgb[_R_] = sRgb[ix][0];
+            pRgb[_G_] = sRgb[ix][1];
+            pRgb[_B_] = sRgb[ix][2];
+        }
+        LEDS_PROF_END(LEDS_PROF_HSV, profHsv);
+
+#if (CONFIG_LEDS_FADE_MS > 0)
+        // ..blend in the previous colours..
+        LEDS_PROF_BEGIN(profFade);
+        for (uint16_t chIx = 0; chIx < LEDS_NUM_CH; chIx++)
+        {
+            if (sLedsFadeT[chIx] > 0)
+            {
+                sLedsFade(chIx, frameDt);
+                fps = MAX(fps, LEDS_FADE_FPS);
+                animating = true;
+            }
+        }
+        LEDS_PROF_END(LEDS_PROF_FADE, profFade);
+#endif
+
+        // ..and fan it out to the LEDs
+        LEDS_PROF_BEGIN(profMap);
+        for (uint16_t ledIx = 0; ledIx < LEDS_NUM; ledIx++)
+        {
+            const uint8_t chIx = sLedsMap[ledIx];
+            if (chIx == LEDS_MAP_NONE)
+            {
+                sLedsSetRGB(ledIx, 0, 0, 0);
+            }
+            else if (sLedsSpatial[chIx] != LEDS_SPATIAL_NONE)
+            {
+                const uint8_t d = sLedsSpatPos[chIx] - sLedsPhase[ledIx];
+                const uint8_t s = pgm_read_byte(&skLedsSpatialLut[ sLedsSpatial[chIx] - 1 ][d]);
+                sLedsSetRGB(ledIx,
+                    sLedsScale(sLedsChRgb[chIx][_R_], s), sLedsScale(sLedsChRgb[chIx][_G_], s), sLedsScale(sLedsChRgb[chIx][_B_], s));
+            }
+            else
+            {
+                sLedsSetRGB(ledIx, sLedsChRgb[chIx][_R_], sLedsChRgb[chIx][_G_], sLedsChRgb[chIx][_B_]);
+            }
+        }
+        LEDS_PROF_END(LEDS_PROF_MAP, profMap);
+        const uint32_t dtRender = micros() - t0;
+        sLedsRenderTimeSum += dtRender;
+        sLedsRenderTimeNum++;
+        if (dtRender > sLedsRenderTimeMax)
+        {
+            sLedsRenderTimeMax = dtRender;
+        }
+        sAnimating = animating;
+        sSettled = CONFIG_LEDS_DITHER == 0;
+        sLedsTickDiv = fps > 0 ? CLIP(LEDS_FPS / fps, 1, LEDS_FPS) : 1;
+        sLedsFlush(configChanged);
+        LEDS_PROF_END(LEDS_PROF_TASK, profTask);
+#if (CONFIG_LEDS_PROFILE > 0)
+        sLedsProfFrame(profMhz);
+#endif
+    }
+}
+
+
+void ledsSetStateHello(const LEDS_PARAM_t *pkParamHead, const LEDS_PARAM_t *pkParamBow)
+{
+    if (pkParamHead != NULL)
+    {
+        for (int ix = 0; ix < 6; ix++)
+        {
+            LEDS_PARAM_t param1 = *pkParamHead;
+            param1.arg = (30 * ix);
+            ledsSetState(ix, &param1);
+            LEDS_PARAM_t param2 = *pkParamHead;
+            param2.arg = (30 * ix) + (30 / 2);
+            ledsSetState(ix + 6, &param2);
+        }
+    }
+    if (pkParamBow != NULL)
+    {
+        ledsSetState(12, pkParamBow);
+    }
+}
+
+
+/* *********************************************************************************************** */
+
+static void sLedsMonStatus(void)
+{
+    DEBUG("mon: leds: frames=%u, rendered=%u, flushed=%u, dropped=%u, strips=%d",
+        sLedsNumFrames, sLedsNumRendered, sLedsNumFlushed, sLedsNumDropped, LEDS_NUM_STRIPS);
+    for (int stripIx = 0; stripIx < LEDS_NUM_STRIPS; stripIx++)
+    {
+        // time on the wire (WS2812: 1.25us per bit, SPI: LEDS_SPI_FREQ)
+        const int size = sLedsSpiBufSize[stripIx][sLedsSpiLastIx[stripIx]];
+        const uint16_t numLeds = sLedsStripNum(stripIx);
+        DEBUG("mon: leds: strip%d out=%s frame size=%d wire=%u [us/frame] (%u LEDs)", stripIx,
+            sLedsWs2812Active[stripIx] ? PSTR("ws2812") : (CONFIG_LEDS_SPI_ASYNC ? PSTR("spi-async") : PSTR("spi-sync")),
+            size, sLedsWs2812Active[stripIx] ? ((uint32_t)numLeds * 3 * 8 * 125 / 100) : (uint32_t)((uint64_t)size * 8 * 1000000 / LEDS_SPI_FREQ),
+            numLeds);
+        DEBUG("mon: leds: strip%d out blocked avg=%u max=%u, pack avg=%u max=%u [us/frame]", stripIx,
+            sLedsSpiWaitNum[stripIx] > 0 ? sLedsSpiWaitSum[stripIx] / sLedsSpiWaitNum[stripIx] : 0, sLedsSpiWaitMax[stripIx],
+            sLedsPackTimeNum[stripIx] > 0 ? sLedsPackTimeSum[stripIx] / sLedsPackTimeNum[stripIx] : 0, sLedsPackTimeMax[stripIx]);
+    }
+    const uint32_t renderAvg = sLedsRenderTimeNum > 0 ? sLedsRenderTimeSum / sLedsRenderTimeNum : 0;
+    DEBUG("mon: leds: render avg=%u max=%u [us/frame] (%d channels, %u ns/channel, %d LEDs)",
+        renderAvg, sLedsRenderTimeMax, LEDS_NUM_CH, renderAvg * 1000 / LEDS_NUM_CH, LEDS_NUM);
+    DEBUG("mon: leds: tick late=%u missed=%u max=%u [us] hist <5=%u <8=%u <12=%u <15=%u <20=%u <50=%u <100=%u >=100=%u [ms]",
+        sLedsClockLate, sLedsClockMissed, sLedsClockMax,
+        sLedsClockHist[0], sLedsClockHist[1], sLedsClockHist[2], sLedsClockHist[3],
+        sLedsClockHist[4], sLedsClockHist[5], sLedsClockHist[6], sLedsClockHist[7]);
+    DEBUG("mon: leds: fps=%u (%u ticks/frame) hist 1=%u 2=%u 3-4=%u 5+=%u [ticks/frame]",
+        LEDS_FPS / sLedsTickDiv, sLedsTickDiv,
+        sLedsTickDivHist[0], sLedsTickDivHist[1], sLedsTickDivHist[2], sLedsTickDivHist[3]);
+#if (CONFIG_LEDS_PROFILE > 0)
+    sLedsProfPrint(PSTR("mon: "), NULL, 0);
+#endif
+}
+
+void ledsProfile(char *report, const int size)
+{
+#if (CONFIG_LEDS_PROFILE > 0)
+    sLedsProfPrint(PSTR(""), report, size);
+#else
+    PRINT("leds: profiler not compiled in (CONFIG_LEDS_PROFILE)");
+    if (report != NULL)
+    {
+        snprintf_P(report, size, PSTR("n/a"));
+    }
+#endif
+}
+
+Ticker sLedsTaskTicker;
+
+void ledsInit(void)
+{
+    DEBUG("leds: init (sckPin=" STRINGIFY(CONFIG_SPI_SCK_PIN) ", misoPin=" STRINGIFY(CONFIG_SPI_MISO_PIN)
+        ", mosiPin=" STRINGIFY(CONFIG_SPI_MOSI_PIN) ", ssPin=" STRINGIFY(CONFIG_SPI_SS_PIN)
+        ", ws2812Pin=" STRINGIFY(CONFIG_LEDS_WS2812_PIN)
+        ", numLeds=%u, numStrips=%u, stripMax=%u, bufSize=%u, ws2801buf=%u, ws2812buf=%u, sk9822buf=%u, spi=%ux2x%ux4=%u)",
+        LEDS_NUM, LEDS_NUM_STRIPS, LEDS_STRIP_MAX, sizeof(sLedsData),
+        LEDS_WS2801_BUFSIZE, LEDS_WS2812_BUFSIZE, LEDS_SK9822_BUFSIZE(LEDS_STRIP_MAX),
+        LEDS_NUM_STRIPS, NUMOF(sLedsSpiBuf[0][0]), sizeof(sLedsSpiBuf));
+
+    sLedsSpiInit();
+    
+    memset(sLedsFx, LEDS_FX_STILL, sizeof(sLedsFx));
+    sLedsRandSeed(CONFIG_LEDS_SEED);
+    sLedsMapLoad(NULL);
+
+    sLedsClear();
+    for (int stripIx = 0; stripIx < LEDS_NUM_STRIPS; stripIx++)
+    {
+        sLedsPackSelect(stripIx, CFG_DRIVER_SK9822, CFG_ORDER_RGB, CFG_BRIGHT_LOW);
+    }
+    sLedsFlush();
+    delay(100);
+    for (int stripIx = 0; stripIx < LEDS_NUM_STRIPS; stripIx++)
+    {
+        sLedsPackSelect(stripIx, CFG_DRIVER_WS2801, CFG_ORDER_RGB, CFG_BRIGHT_LOW);
+    }
+    sLedsFlush();
+    delay(100);
+    for (int stripIx = 0; stripIx < LEDS_NUM_STRIPS; stripIx++)
+    {
+        sLedsPackSelect(stripIx, CFG_DRIVER_UNKNOWN, CFG_ORDER_UNKNOWN, CFG_BRIGHT_UNKNOWN);
+    }
+    
+    debugRegisterMon(sLedsMonStatus);
+
     sLedsTaskTicker.attach_ms(1000 / LEDS_FPS, sLedsTask);
 }
 
@@ -1,6 +1,6 @@
 /*!
     \file
-    \brief flipflip's Tschenggins Lämpli: LEDS WS2801 and SK9822 LED driver (see \ref FF_LEDS)
+    \brief flipflip's Tschenggins Lämpli: LEDS WS2801, WS2812 and SK9822 LED driver (see \ref FF_LEDS)
 
     - Copyright (c) 2017-2020 Philippe Kehl (flipflip at oinkzwurgl dot org),
       https://oinkzwurgl.org/projaeggd/tschenggins-laempli
@@ -17,9 +17,31 @@
 
 #include "config.h"
 
-#define LEDS_NUM CONFIG_NUM_CH
+//! number of LEDs (by default one per channel)
+#ifndef CONFIG_LEDS_NUM
+#  define CONFIG_LEDS_NUM CONFIG_NUM_CH
+#endif
 
-#define LEDS_FPS 100
+#define LEDS_NUM CONFIG_LEDS_NUM
+
+//! number of LED strips, the ESP32 can drive a second one (on the HSPI bus, or on the second RMT channel)
+#ifndef CONFIG_LEDS_STRIPS
+#  define CONFIG_LEDS_STRIPS 1
+#endif
+
+#define LEDS_NUM_STRIPS CONFIG_LEDS_STRIPS
+
+//! number of LEDs on the first strip, the remaining LEDs are on the second strip
+#ifndef CONFIG_LEDS_STRIP0_NUM
+#  define CONFIG_LEDS_STRIP0_NUM ((LEDS_NUM + 1) / 2)
+#endif
+
+//! LED task tick rate [Hz], i.e. the highest frame rate (must divide 1000)
+#ifndef CONFIG_LEDS_FPS
+#  define CONFIG_LEDS_FPS 100
+#endif
+
+#define LEDS_FPS CONFIG_LEDS_FPS
 
 //! initialise
 void ledsInit(void);
@@ -33,6 +55,9 @@ typedef enum LEDS_FX_e
     LEDS_FX_PULSE,
     LEDS_FX_FLICKER,
     LEDS_FX_BLINK,
+    LEDS_FX_ROTATE,  // beam going round (lighthouse), along the channel's LEDs
+    LEDS_FX_CHASE,   // lit and dark segments chasing along the channel's LEDs
+    LEDS_FX_COMET,   // bright head with a fading tail, along the channel's LEDs
 
 } LEDS_FX_t;
 
@@ -54,10 +79,31 @@ typedef struct LEDS_PARAM_s
     { .hue = (_hue), .sat = (_sat), .val = (_val), .fx = CONCAT(LEDS_FX_, _fx), .arg = (_arg) }
 
 
-void ledsSetState(const uint16_t ledIx, const LEDS_PARAM_t *pkParam);
+//! set channel state
+/*!
+    The channel is shown on the LEDs given by the "leds" config (see cfgGetLeds()), by default channel 0 on
+    LED 0, channel 1 on LED 1, etc. The config lists the LEDs for each channel separated by ";", e.g.
+    "0-4;5-9;10,12-14" shows channel 0 on LEDs 0..4, channel 1 on 5..9 and channel 2 on 10 and 12..14.
+
+    The spatial effects (#LEDS_FX_ROTATE, #LEDS_FX_CHASE, #LEDS_FX_COMET) move along the channel's LEDs
+    (in the order listed) as laid out by a suffix: "r" = ring (wraps around), "l" = line (default, runs
+    off the end before starting over), "m<w>" = matrix with w columns (the columns move, the rows are the
+    same), e.g. "0-11r;12-19;20-35m4".
+
+    \param[in] chIx     channel index
+    \param[in] pkParam  state
+*/
+void ledsSetState(const uint16_t chIx, const LEDS_PARAM_t *pkParam);
 
 void ledsSetStateHello(const LEDS_PARAM_t *pkParamHead, const LEDS_PARAM_t *pkParamBow);
 
+//! print the render pipeline profile (time spent per stage since the last time, see CONFIG_LEDS_PROFILE)
+/*!
+    \param[out] report  optional (NULL = none) summary of the profile for the backend (see backendGetReport())
+    \param[in]  size    size of the report buffer
+*/
+void ledsProfile(char *report, const int size);
+
 #endif // __LEDS_H__
 //@}
 // eof
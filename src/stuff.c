@@ -13,8 +13,16 @@
 
 #include <pgmspace.h>
 #include <ctype.h>
+#if defined(ESP8266)
+#  include <user_interface.h>
+#endif
 
 #include "stuff.h"
+#include "config.h"
+
+#ifndef CONFIG_CPU_BOOST_MHZ
+#  define CONFIG_CPU_BOOST_MHZ 0
+#endif
 
 int strncmp_PP(const char *s1, const char *s2, int size)
 {
@@ -84,6 +92,59 @@ uint32_t getTime(void)
     return sTimePosix + ((now - sTimeMillis) / 1000);
 }
 
+/* *********************************************************************************************** */
+
+#if (CONFIG_CPU_BOOST_MHZ > 0)
+static int sCpuBoostCnt;
+static uint32_t sCpuBaseMhz;
+
+static uint32_t sCpuGetMhz(void)
+{
+#if defined(ESP8266)
+    return system_get_cpu_freq();
+#elif defined(ESP32)
+    return getCpuFrequencyMhz();
+#endif
+}
+
+static void sCpuSetMhz(const uint32_t mhz)
+{
+#if defined(ESP8266)
+    system_update_cpu_freq(mhz);
+#elif defined(ESP32)
+    setCpuFrequencyMhz(mhz);
+#endif
+}
+#endif // (CONFIG_CPU_BOOST_MHZ > 0)
+
+void cpuBoost(const bool boost)
+{
+#if (CONFIG_CPU_BOOST_MHZ > 0)
+    if (boost)
+    {
+        if (sCpuBoostCnt == 0)
+        {
+            sCpuBaseMhz = sCpuGetMhz();
+            if (sCpuBaseMhz < CONFIG_CPU_BOOST_MHZ)
+            {
+                sCpuSetMhz(CONFIG_CPU_BOOST_MHZ);
+            }
+        }
+        sCpuBoostCnt++;
+    }
+    else if (sCpuBoostCnt > 0)
+    {
+        sCpuBoostCnt--;
+        if ( (sCpuBoostCnt == 0) && (sCpuBaseMhz < CONFIG_CPU_BOOST_MHZ) )
+        {
+            sCpuSetMhz(sCpuBaseMhz);
+        }
+    }
+#else
+    UNUSED(boost);
+#endif
+}
+
 
 /* *********************************************************************************************** */
 
@@ -134,6 +134,17 @@ void setTime(const uint32_t timestamp);
 //! get (approximate) POSIX time
 uint32_t getTime(void);
 
+//! temporarily run the CPU faster (#CONFIG_CPU_BOOST_MHZ) for CPU intensive things
+/*!
+    Calls can be nested, the CPU is switched back to the normal frequency by the last cpuBoost(false).
+    Nothing happens if the CPU already runs at (or above) that frequency.
+    Timers and the SPI clock are derived from the APB clock, which does not change. However, on the
+    ESP8266 the tone() waveform generator counts CPU cycles, so don't boost while a tone is playing.
+
+    \param[in] boost  true to boost, false to release the boost
+*/
+void cpuBoost(const bool boost);
+
 /* *********************************************************************************************** */
 
 #ifdef __cplusplus
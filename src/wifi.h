@@ -22,6 +22,15 @@ bool wifiWaitForConnect(void);
 
 bool wifiConnectBackend(void);
 
+//! look for a better AP, call this regularly while connected
+/*!
+    Switching to another AP drops all connections. So a better AP is only remembered, and switched to when
+    the backend connection is closed for a planned reconnect.
+
+    \returns true if the signal is weak and the connections should be closed now to switch to the better AP
+*/
+bool wifiRoam(void);
+
 #endif // __WIFI_H__
 //@}
 // eof
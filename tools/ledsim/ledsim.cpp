@@ -0,0 +1,731 @@
+/*!
+    \file
+    \brief flipflip's Tschenggins Lämpli: LED simulator
+
+    - Copyright (c) 2020 Philippe Kehl (flipflip at oinkzwurgl dot org),
+      https://oinkzwurgl.org/projaeggd/tschenggins-laempli
+
+    Runs src/leds.cpp (the ESP32 variant, with the synchronous SPI) and src/hsv2rgb.c on the host. The
+    stubs (see stubs/) capture the bytes the LED task would send to the LED strip. The simulator decodes
+    them back into RGB values for a preview on the terminal or as images, checksums them to detect
+    changes in the output (see golden.txt) and benchmarks the LED task.
+
+    Use ledsim.sh to build and run it.
+*/
+
+#include <time.h>
+#include <errno.h>
+#include <stdarg.h>
+#include <unistd.h>
+
+#include "../../src/leds.cpp"
+
+/* *********************************************************************************************** */
+
+static bool     sSimVerbose;
+static int      sSimFx = -1;  // all channels use this effect (LEDS_FX_t), -1 = a bit of everything
+static uint32_t sSimUs = 1; // simulated time [us]
+
+uint32_t micros(void)
+{
+    return sSimUs;
+}
+
+uint32_t millis(void)
+{
+    return sSimUs / 1000;
+}
+
+void delay(uint32_t ms)
+{
+    sSimUs += ms * 1000;
+}
+
+void delayMicroseconds(uint32_t us)
+{
+    sSimUs += us;
+}
+
+SimSerial Serial;
+
+int SimSerial::printf_P(const char *fmt, ...)
+{
+    if (!sSimVerbose)
+    {
+        return 0;
+    }
+    va_list args;
+    va_start(args, fmt);
+    const int res = vfprintf(stderr, fmt, args);
+    va_end(args);
+    return res;
+}
+
+void SimSerial::flush(void)
+{
+    fflush(stderr);
+}
+
+SimEsp ESP;
+
+static uint64_t sSimHostNs(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ((uint64_t)ts.tv_sec * 1000000000) + ts.tv_nsec;
+}
+
+uint32_t SimEsp::getCycleCount(void)
+{
+    return (uint32_t)sSimHostNs();
+}
+
+uint32_t SimEsp::getCpuFreqMHz(void)
+{
+    return 1000;
+}
+
+void debugRegisterMon(DEBUG_MON_FUNC_t monFunc)
+{
+    (void)monFunc;
+}
+
+/* *********************************************************************************************** */
+
+static CFG_DRIVER_t sSimDriver = CFG_DRIVER_WS2801;
+static CFG_ORDER_t  sSimOrder  = CFG_ORDER_RGB;
+static CFG_BRIGHT_t sSimBright = CFG_BRIGHT_FULL;
+static const char  *sSimLeds   = "";
+static CFG_HUES_t   sSimHues   = CFG_HUES_CLASSIC;
+static CFG_DRIVER_t sSimDriver2 = CFG_DRIVER_UNKNOWN; // unknown = same as the first strip
+static int          sSimOrder2  = -1;                 // -1 = same as the first strip
+
+CFG_DRIVER_t cfgGetDriver(void)
+{
+    return sSimDriver;
+}
+
+CFG_ORDER_t cfgGetOrder(void)
+{
+    return sSimOrder;
+}
+
+CFG_DRIVER_t cfgGetDriver2(void)
+{
+    return sSimDriver2 != CFG_DRIVER_UNKNOWN ? sSimDriver2 : sSimDriver;
+}
+
+CFG_ORDER_t cfgGetOrder2(void)
+{
+    return sSimOrder2 >= 0 ? (CFG_ORDER_t)sSimOrder2 : sSimOrder;
+}
+
+CFG_BRIGHT_t cfgGetBright(void)
+{
+    return sSimBright;
+}
+
+CFG_HUES_t cfgGetHues(void)
+{
+    return sSimHues;
+}
+
+const char *cfgGetLeds(void)
+{
+    return sSimLeds;
+}
+
+uint32_t cfgGetLedsGen(void)
+{
+    return 1;
+}
+
+/* *********************************************************************************************** */
+
+// last frame sent to each LED strip
+static uint8_t  sSimWire[LEDS_NUM_STRIPS][sizeof(sLedsSpiBuf[0][0])];
+static int      sSimWireSize[LEDS_NUM_STRIPS];
+static bool     sSimWireRmt[LEDS_NUM_STRIPS];
+static uint32_t sSimNumSent;
+
+// checksum (FNV-1a) of all frames sent, and when they were sent
+static uint32_t sSimChecksum = 2166136261u;
+
+static void sSimHash(const void *pkData, const int size)
+{
+    const uint8_t *pkBytes = (const uint8_t *)pkData;
+    for (int ix = 0; ix < size; ix++)
+    {
+        sSimChecksum ^= pkBytes[ix];
+        sSimChecksum *= 16777619u;
+    }
+}
+
+static void sSimCapture(const int stripIx, const void *pkData, const int size, const bool rmt)
+{
+    if (stripIx >= LEDS_NUM_STRIPS)
+    {
+        fprintf(stderr, "ledsim: output on strip %d\n", stripIx);
+        return;
+    }
+    const int num = MIN(size, (int)sizeof(sSimWire[stripIx]));
+    memcpy(sSimWire[stripIx], pkData, num);
+    sSimWireSize[stripIx] = num;
+    sSimWireRmt[stripIx] = rmt;
+    sSimNumSent++;
+    const uint32_t tick = sLedsNumFrames;
+    sSimHash(&tick, sizeof(tick));
+    sSimHash(sSimWire[stripIx], sSimWireSize[stripIx]);
+}
+
+void ledsimSpiWrite(const uint8_t bus, const uint8_t *data, const int size)
+{
+    sSimCapture(bus == HSPI ? 1 : 0, data, size, false);
+}
+
+void ledsimRmtWrite(const rmt_channel_t ch, const uint32_t *items, const int num)
+{
+    sSimCapture(ch, items, num * 4, true);
+}
+
+// decode the last frame sent back into RGB values
+static uint8_t sSimRgb[LEDS_NUM][3];
+
+static void sSimDecodeStrip(const int stripIx, const CFG_DRIVER_t driver, const CFG_ORDER_t ledOrder)
+{
+    // colour order, output byte ix is component order[ix]
+    int order[3] = { _R_, _G_, _B_ };
+    switch (ledOrder)
+    {
+        case CFG_ORDER_RGB: order[0] = _R_; order[1] = _G_; order[2] = _B_; break;
+        case CFG_ORDER_RBG: order[0] = _R_; order[1] = _B_; order[2] = _G_; break;
+        case CFG_ORDER_GRB: order[0] = _G_; order[1] = _R_; order[2] = _B_; break;
+        case CFG_ORDER_GBR: order[0] = _G_; order[1] = _B_; order[2] = _R_; break;
+        case CFG_ORDER_BRG: order[0] = _B_; order[1] = _R_; order[2] = _G_; break;
+        case CFG_ORDER_BGR: order[0] = _B_; order[1] = _G_; order[2] = _R_; break;
+        case CFG_ORDER_UNKNOWN: break;
+    }
+
+    const uint8_t *pkWire = sSimWire[stripIx];
+    const int wireSize = sSimWireSize[stripIx];
+    const uint16_t ledIx0 = sLedsStripIx0(stripIx);
+    for (int ledIx = 0; ledIx < sLedsStripNum(stripIx); ledIx++)
+    {
+        uint8_t out[3] = { 0, 0, 0 };
+        if (sSimWireRmt[stripIx])
+        {
+            // WS2812: one RMT item per bit, a long high time is a 1
+            const uint32_t *pkItems = (const uint32_t *)pkWire;
+            const int itemIx = ledIx * 3 * 8;
+            if ((itemIx + (3 * 8)) * 4 > wireSize)
+            {
+                break;
+            }
+            for (int c = 0; c < 3; c++)
+            {
+                for (int b = 0; b < 8; b++)
+                {
+                    const uint32_t high = pkItems[itemIx + (c * 8) + b] & 0x7fff;
+                    out[c] = (out[c] << 1) | (high > ((LEDS_RMT_BIT0 & 0x7fff) + (LEDS_RMT_BIT1 & 0x7fff)) / 2 ? 1 : 0);
+                }
+            }
+        }
+        else if (driver == CFG_DRIVER_SK9822)
+        {
+            // SK9822: start frame, then <0xe0+brightness> <c0> <c1> <c2> per LED (brightness 0..31 scales the current)
+            const int byteIx = 4 + (ledIx * 4);
+            if ((byteIx + 4) > wireSize)
+            {
+                break;
+            }
+            const uint32_t global = pkWire[byteIx + 0] & 0x1f;
+            out[0] = ((pkWire[byteIx + 1] * global) + 15) / 31;
+            out[1] = ((pkWire[byteIx + 2] * global) + 15) / 31;
+            out[2] = ((pkWire[byteIx + 3] * global) + 15) / 31;
+        }
+        else
+        {
+            // WS2801: three bytes per LED
+            const int byteIx = ledIx * 3;
+            if ((byteIx + 3) > wireSize)
+            {
+                break;
+            }
+            out[0] = pkWire[byteIx + 0];
+            out[1] = pkWire[byteIx + 1];
+            out[2] = pkWire[byteIx + 2];
+        }
+        for (int c = 0; c < 3; c++)
+        {
+            sSimRgb[ledIx0 + ledIx][order[c]] = out[c];
+        }
+    }
+}
+
+static void sSimDecode(void)
+{
+    memset(sSimRgb, 0, sizeof(sSimRgb));
+    sSimDecodeStrip(0, cfgGetDriver(), cfgGetOrder());
+#if (LEDS_NUM_STRIPS > 1)
+    sSimDecodeStrip(1, cfgGetDriver2(), cfgGetOrder2());
+#endif
+}
+
+/* *********************************************************************************************** */
+
+// terminal preview, one block per LED (24 bit colour escape sequences)
+static void sSimTerminal(const uint32_t frame)
+{
+    printf("\r%6u ", frame);
+    for (int ledIx = 0; ledIx < LEDS_NUM; ledIx++)
+    {
+        printf("\033[48;2;%u;%u;%um  ", sSimRgb[ledIx][_R_], sSimRgb[ledIx][_G_], sSimRgb[ledIx][_B_]);
+    }
+    printf("\033[0m");
+    fflush(stdout);
+}
+
+// one image per frame, one 8x8 pixel square per LED
+#define SIM_PPM_SIZE 8
+
+static bool sSimPpm(const char *dir, const uint32_t frame)
+{
+    char path[1024];
+    snprintf(path, sizeof(path), "%s/frame_%06u.ppm", dir, frame);
+    FILE *pFile = fopen(path, "wb");
+    if (pFile == NULL)
+    {
+        fprintf(stderr, "ledsim: cannot write %s: %s\n", path, strerror(errno));
+        return false;
+    }
+    fprintf(pFile, "P6\n%d %d\n255\n", LEDS_NUM * SIM_PPM_SIZE, SIM_PPM_SIZE);
+    for (int y = 0; y < SIM_PPM_SIZE; y++)
+    {
+        for (int ledIx = 0; ledIx < LEDS_NUM; ledIx++)
+        {
+            for (int x = 0; x < SIM_PPM_SIZE; x++)
+            {
+                fwrite(sSimRgb[ledIx], 3, 1, pFile);
+            }
+        }
+    }
+    fclose(pFile);
+    return true;
+}
+
+/* *********************************************************************************************** */
+
+// the scene: a bit of everything, a few state changes and a few repeated (unchanged) states
+static void sSimScene(const uint32_t frame)
+{
+    if ((frame % 200) != 0)
+    {
+        return;
+    }
+    const int step = frame / 200;
+    for (uint16_t chIx = 0; chIx < LEDS_NUM_CH; chIx++)
+    {
+        LEDS_PARAM_t param;
+        param.hue = (chIx * 256 / LEDS_NUM_CH) + (step == 2 ? 85 : 0);
+        param.sat = 255;
+        param.val = 255;
+        param.arg = (chIx * 100);
+        switch (sSimFx >= 0 ? sSimFx : (chIx + (step >= 2 ? 1 : 0)) % 4)
+        {
+            case 0: param.fx = LEDS_FX_STILL;   break;
+            case 1: param.fx = LEDS_FX_PULSE;   break;
+            case 2: param.fx = LEDS_FX_FLICKER; break;
+            case 3: param.fx = LEDS_FX_BLINK; param.arg = (chIx & 0x1 ? -1 : 1) * (25 + chIx); break;
+            case 4: param.fx = LEDS_FX_ROTATE;  break;
+            case 5: param.fx = LEDS_FX_CHASE;   break;
+            case 6: param.fx = LEDS_FX_COMET;   break;
+        }
+        ledsSetState(chIx, &param);
+    }
+}
+
+// compare hsv2rgb() for each colour (as it used to be done) to hsv2rgbMany() for a whole frame
+static void sSimBenchHsv(void)
+{
+    static uint8_t H[LEDS_NUM_CH], S[LEDS_NUM_CH], V[LEDS_NUM_CH], RGB[LEDS_NUM_CH][3];
+    const int numFrames = 100000;
+    volatile uint8_t sink = 0;
+    srand(1);
+    for (int ix = 0; ix < LEDS_NUM_CH; ix++)
+    {
+        H[ix] = rand();
+        S[ix] = rand();
+        V[ix] = rand();
+    }
+
+    uint64_t t0 = sSimHostNs();
+    for (int frame = 0; frame < numFrames; frame++)
+    {
+        V[frame % LEDS_NUM_CH]++;
+        for (int ix = 0; ix < LEDS_NUM_CH; ix++)
+        {
+            hsv2rgb(H[ix], S[ix], V[ix], &RGB[ix][0], &RGB[ix][1], &RGB[ix][2]);
+        }
+        sink ^= RGB[frame % LEDS_NUM_CH][0];
+    }
+    const uint64_t nsSingle = sSimHostNs() - t0;
+
+    uint64_t nsMany[2];
+    for (int mode = 0; mode < 2; mode++)
+    {
+        t0 = sSimHostNs();
+        for (int frame = 0; frame < numFrames; frame++)
+        {
+            V[frame % LEDS_NUM_CH]++;
+            hsv2rgbMany(H, S, V, &RGB[0][0], LEDS_NUM_CH, mode == 0 ? HSV2RGB_MODE_CLASSIC : HSV2RGB_MODE_RAINBOW);
+            sink ^= RGB[frame % LEDS_NUM_CH][0];
+        }
+        nsMany[mode] = sSimHostNs() - t0;
+    }
+
+    const double n = (double)numFrames * LEDS_NUM_CH;
+    printf("hsv2rgb colours=%d: single %.2f ns/colour, many classic %.2f ns/colour, many rainbow %.2f ns/colour (host)\n",
+        LEDS_NUM_CH, (double)nsSingle / n, (double)nsMany[0] / n, (double)nsMany[1] / n);
+}
+
+// draw many flicker steps and compare to the distributions (within +/- 1%), the ranges may overlap
+static bool sSimFlickerDist(const char *name, const LEDS_FLICKER_DIST_t *pkDist, const int num, const uint32_t *pkHist,
+    const uint32_t total)
+{
+    // expected probability of each value
+    double expected[256] = { 0.0 };
+    for (int distIx = 0; distIx < num; distIx++)
+    {
+        const int range = pkDist[distIx].max - pkDist[distIx].min;
+        for (int val = pkDist[distIx].min; val < pkDist[distIx].max; val++)
+        {
+            expected[val] += (double)pkDist[distIx].percent / (double)range;
+        }
+    }
+
+    bool res = true;
+    for (int distIx = 0; distIx < num; distIx++)
+    {
+        uint32_t count = 0;
+        double percentExp = 0.0;
+        for (int val = pkDist[distIx].min; val < pkDist[distIx].max; val++)
+        {
+            count += pkHist[val];
+            percentExp += expected[val];
+        }
+        const double percent = (double)count * 100.0 / (double)total;
+        const bool ok = fabs(percent - percentExp) <= 1.0;
+        printf("%-8s %3u..%3u: %5.1f%% (expected %5.1f%%) %s\n", name, pkDist[distIx].min, pkDist[distIx].max - 1,
+            percent, percentExp, ok ? "ok" : "FAIL");
+        res = res && ok;
+    }
+    return res;
+}
+
+static bool sSimFlickerStats(void)
+{
+    static uint32_t histVal[256];
+    static uint32_t histDur[256];
+    const uint32_t total = 1000000;
+    for (uint32_t n = 0; n < total; n++)
+    {
+        const uint16_t chIx = n % LEDS_NUM_CH;
+        sLedsAnimT[chIx] = 0;
+        histVal[sLedsFlicker(chIx, 0)]++;
+        histDur[sLedsAnimT[chIx]]++;
+    }
+    bool res = sSimFlickerDist("value", skLedsFlickerVal, NUMOF(skLedsFlickerVal), histVal, total);
+    res = sSimFlickerDist("duration", skLedsFlickerDur, NUMOF(skLedsFlickerDur), histDur, total) && res;
+    return res;
+}
+
+// the lookup tables in leds.cpp are constants (in flash), this is how they're made
+static void sSimFlickerLutBuild(uint8_t *pLut, const LEDS_FLICKER_DIST_t *pkDist, const int num)
+{
+    int lutIx = 0;
+    int percent = 0;
+    for (int distIx = 0; distIx < num; distIx++)
+    {
+        // number of entries for this range (cumulative, so that the rounding errors don't add up)
+        percent += pkDist[distIx].percent;
+        const int lutEnd = distIx < (num - 1) ? ((percent * 256) + 50) / 100 : 256;
+        const int n = lutEnd - lutIx;
+        const int range = pkDist[distIx].max - pkDist[distIx].min;
+        for (int ix = 0; ix < n; ix++)
+        {
+            pLut[lutIx++] = pkDist[distIx].min + ((ix * range) / n);
+        }
+    }
+}
+
+static bool sSimLutCheck(const char *name, const uint8_t *pkLut, const uint8_t *pkExpected)
+{
+    int numDiff = 0;
+    for (int ix = 0; ix < 256; ix++)
+    {
+        if (pkLut[ix] != pkExpected[ix])
+        {
+            numDiff++;
+        }
+    }
+    printf("lut %-12s %3d different %s\n", name, numDiff, numDiff == 0 ? "ok" : "FAIL");
+    if (numDiff > 0)
+    {
+        for (int ix = 0; ix < 256; ix++)
+        {
+            printf("%s%3u,%s", (ix % 16) == 0 ? "    " : " ", pkExpected[ix], (ix % 16) == 15 ? "\n" : "");
+        }
+    }
+    return numDiff == 0;
+}
+
+static bool sSimLuts(void)
+{
+    uint8_t lut[256];
+    sSimFlickerLutBuild(lut, skLedsFlickerVal, NUMOF(skLedsFlickerVal));
+    bool res = sSimLutCheck("flicker val", skLedsFlickerValLut, lut);
+    sSimFlickerLutBuild(lut, skLedsFlickerDur, NUMOF(skLedsFlickerDur));
+    res = sSimLutCheck("flicker dur", skLedsFlickerDurLut, lut) && res;
+
+    static const LEDS_KEY_t skBeam[] = { { 0, 255, LEDS_EASE_SINE }, { 32768, 26, LEDS_EASE_SINE } };
+    for (uint32_t d = 0; d < 256; d++)
+    {
+        lut[d] = sLedsCurve(skBeam, NUMOF(skBeam), d << 8);
+    }
+    res = sSimLutCheck("beam", skLedsSpatialLut[LEDS_SPATIAL_BEAM - 1], lut) && res;
+    for (uint32_t d = 0; d < 256; d++)
+    {
+        lut[d] = (d & 0x3f) < 0x20 ? 255 : 0;
+    }
+    res = sSimLutCheck("chase", skLedsSpatialLut[LEDS_SPATIAL_CHASE - 1], lut) && res;
+    for (uint32_t d = 0; d < 256; d++)
+    {
+        lut[d] = d < 128 ? (255 * sLedsEase(LEDS_EASE_IN, (128 - d) * 2)) >> 8 : 0;
+    }
+    res = sSimLutCheck("comet", skLedsSpatialLut[LEDS_SPATIAL_COMET - 1], lut) && res;
+    return res;
+}
+
+// all channels still (and dim, so that the output has fractions), after the crossfade every (re-)sent frame
+// must be the same
+static bool sSimStillRefresh(const uint32_t numFrames)
+{
+    for (uint16_t chIx = 0; chIx < LEDS_NUM_CH; chIx++)
+    {
+        LEDS_PARAM_t param;
+        param.hue = chIx * 256 / LEDS_NUM_CH;
+        param.sat = 200;
+        param.val = 30 + chIx;
+        param.fx  = LEDS_FX_STILL;
+        param.arg = 0;
+        ledsSetState(chIx, &param);
+    }
+    static uint8_t wire[NUMOF(sSimWire)][NUMOF(sSimWire[0])];
+    uint32_t numSent = 0;
+    uint32_t numDiff = 0;
+    uint32_t lastSent = sSimNumSent;
+    for (uint32_t frame = 0; frame < numFrames; frame++)
+    {
+        sSimUs += 1000000 / LEDS_FPS;
+        sLedsTask();
+        if ( ((frame * 1000 / LEDS_FPS) < (2 * CONFIG_LEDS_FADE_MS)) || (sSimNumSent == lastSent) )
+        {
+            memcpy(wire, sSimWire, sizeof(wire));
+            lastSent = sSimNumSent;
+            continue;
+        }
+        numSent += sSimNumSent - lastSent;
+        lastSent = sSimNumSent;
+        if (memcmp(wire, sSimWire, sizeof(wire)) != 0)
+        {
+            numDiff++;
+        }
+    }
+    const bool ok = (numSent >= 2) && (numDiff == 0);
+    printf("still refresh: %u frames sent, %u different %s\n", numSent, numDiff, ok ? "ok" : "FAIL");
+    return ok;
+}
+
+static void sSimUsage(void)
+{
+    fprintf(stderr,
+        "Usage: ledsim [options]\n"
+        "\n"
+        "    -d <driver>    ws2801 (default), ws2812 or sk9822\n"
+        "    -o <order>     rgb (default), rbg, grb, gbr, brg, bgr or unknown\n"
+        "    -D <driver>    driver of the second strip (default: same as the first)\n"
+        "    -O <order>     colour order of the second strip (default: same as the first)\n"
+        "    -b <bright>    full (default), high, medium, low or unknown\n"
+        "    -m <map>       channel to LEDs map (see ledsSetState())\n"
+        "    -r             rainbow hues (instead of classic)\n"
+        "    -e <fx>        all channels use effect still, pulse, flicker, blink, rotate, chase or comet (instead of a bit of everything)\n"
+        "    -n <frames>    number of frames (ticks) to run (default 1000)\n"
+        "    -t             preview on the terminal (in real time)\n"
+        "    -p <dir>       write each frame to <dir>/frame_NNNNNN.ppm\n"
+        "    -c             print checksum of the frames sent\n"
+        "    -g <checksum>  compare checksum of the frames sent, exit 1 on mismatch\n"
+        "    -B             benchmark the LED task\n"
+        "    -H             benchmark the HSV to RGB conversion\n"
+        "    -F             check the flicker effect's distributions\n"
+        "    -L             check the lookup tables (flicker, spatial effects)\n"
+        "    -S             check that an all-still scene re-sends the same frame (use with -b)\n"
+        "    -v             show debug output\n"
+        "\n"
+        "LEDs: %d, channels: %d, strips: %d, FPS: %d\n", LEDS_NUM, LEDS_NUM_CH, LEDS_NUM_STRIPS, LEDS_FPS);
+}
+
+int main(int argc, char **argv)
+{
+    uint32_t numFrames = 1000;
+    bool doTerminal = false;
+    const char *ppmDir = NULL;
+    bool doChecksum = false;
+    const char *golden = NULL;
+    bool doBench = false;
+    bool doStill = false;
+
+    int opt;
+    while ((opt = getopt(argc, argv, "d:o:D:O:b:m:re:n:tp:cg:BHFLSvh")) != -1)
+    {
+        switch (opt)
+        {
+            case 'd':
+            case 'D':
+            {
+                CFG_DRIVER_t driver;
+                if      (strcasecmp(optarg, "ws2801") == 0) { driver = CFG_DRIVER_WS2801; }
+                else if (strcasecmp(optarg, "ws2812") == 0) { driver = CFG_DRIVER_WS2812; }
+                else if (strcasecmp(optarg, "sk9822") == 0) { driver = CFG_DRIVER_SK9822; }
+                else { sSimUsage(); return 2; }
+                *(opt == 'd' ? &sSimDriver : &sSimDriver2) = driver;
+                break;
+            }
+            case 'o':
+            case 'O':
+            {
+                CFG_ORDER_t order;
+                if      (strcasecmp(optarg, "rgb") == 0)     { order = CFG_ORDER_RGB; }
+                else if (strcasecmp(optarg, "rbg") == 0)     { order = CFG_ORDER_RBG; }
+                else if (strcasecmp(optarg, "grb") == 0)     { order = CFG_ORDER_GRB; }
+                else if (strcasecmp(optarg, "gbr") == 0)     { order = CFG_ORDER_GBR; }
+                else if (strcasecmp(optarg, "brg") == 0)     { order = CFG_ORDER_BRG; }
+                else if (strcasecmp(optarg, "bgr") == 0)     { order = CFG_ORDER_BGR; }
+                else if (strcasecmp(optarg, "unknown") == 0) { order = CFG_ORDER_UNKNOWN; }
+                else { sSimUsage(); return 2; }
+                if (opt == 'o')
+                {
+                    sSimOrder = order;
+                }
+                else
+                {
+                    sSimOrder2 = order;
+                }
+                break;
+            }
+            case 'b':
+                if      (strcasecmp(optarg, "full") == 0)    { sSimBright = CFG_BRIGHT_FULL; }
+                else if (strcasecmp(optarg, "high") == 0)    { sSimBright = CFG_BRIGHT_HIGH; }
+                else if (strcasecmp(optarg, "medium") == 0)  { sSimBright = CFG_BRIGHT_MEDIUM; }
+                else if (strcasecmp(optarg, "low") == 0)     { sSimBright = CFG_BRIGHT_LOW; }
+                else if (strcasecmp(optarg, "unknown") == 0) { sSimBright = CFG_BRIGHT_UNKNOWN; }
+                else { sSimUsage(); return 2; }
+                break;
+            case 'e':
+                if      (strcasecmp(optarg, "still") == 0)   { sSimFx = LEDS_FX_STILL; }
+                else if (strcasecmp(optarg, "pulse") == 0)   { sSimFx = LEDS_FX_PULSE; }
+                else if (strcasecmp(optarg, "flicker") == 0) { sSimFx = LEDS_FX_FLICKER; }
+                else if (strcasecmp(optarg, "blink") == 0)   { sSimFx = LEDS_FX_BLINK; }
+                else if (strcasecmp(optarg, "rotate") == 0)  { sSimFx = LEDS_FX_ROTATE; }
+                else if (strcasecmp(optarg, "chase") == 0)   { sSimFx = LEDS_FX_CHASE; }
+                else if (strcasecmp(optarg, "comet") == 0)   { sSimFx = LEDS_FX_COMET; }
+                else { sSimUsage(); return 2; }
+                break;
+            case 'm': sSimLeds   = optarg;                   break;
+            case 'r': sSimHues   = CFG_HUES_RAINBOW;         break;
+            case 'n': numFrames  = strtoul(optarg, NULL, 0); break;
+            case 't': doTerminal = true;                     break;
+            case 'p': ppmDir     = optarg;                   break;
+            case 'c': doChecksum = true;                     break;
+            case 'g': golden     = optarg;                   break;
+            case 'B': doBench    = true;                     break;
+            case 'H': sSimBenchHsv(); return 0;
+            case 'F': ledsInit(); return sSimFlickerStats() ? 0 : 1;
+            case 'L': return sSimLuts() ? 0 : 1;
+            case 'S': doStill    = true;                     break;
+            case 'v': sSimVerbose = true;                    break;
+            default:
+                sSimUsage();
+                return 2;
+        }
+    }
+
+    ledsInit();
+    sSimChecksum = 2166136261u; // ignore the frames sent by ledsInit()
+
+    if (doStill)
+    {
+        return sSimStillRefresh(numFrames) ? 0 : 1;
+    }
+
+    uint64_t benchNs = 0;
+    for (uint32_t frame = 0; frame < numFrames; frame++)
+    {
+        sSimScene(frame);
+
+        sSimUs += 1000000 / LEDS_FPS;
+        const uint64_t t0 = doBench ? sSimHostNs() : 0;
+        sLedsTask();
+        if (doBench)
+        {
+            benchNs += sSimHostNs() - t0;
+        }
+
+        if (doTerminal || (ppmDir != NULL))
+        {
+            sSimDecode();
+            if (doTerminal)
+            {
+                sSimTerminal(frame);
+                usleep(1000000 / LEDS_FPS);
+            }
+            if ( (ppmDir != NULL) && !sSimPpm(ppmDir, frame) )
+            {
+                return 1;
+            }
+        }
+    }
+    if (doTerminal)
+    {
+        printf("\n");
+    }
+
+    if (sSimVerbose)
+    {
+        sLedsMonStatus();
+    }
+
+    if (doBench)
+    {
+        const double usPerFrame = (double)benchNs / 1e3 / (double)numFrames;
+        printf("driver=%s leds=%d channels=%d frames=%u sent=%u: %.2f us/frame, %.0f frames/s (host)\n",
+            sSimDriver == CFG_DRIVER_WS2801 ? CFG_DRIVER_WS2801_STR : (sSimDriver == CFG_DRIVER_WS2812 ? CFG_DRIVER_WS2812_STR : CFG_DRIVER_SK9822_STR),
+            LEDS_NUM, LEDS_NUM_CH, numFrames, sSimNumSent, usPerFrame, 1e6 / usPerFrame);
+    }
+
+    char checksum[20];
+    snprintf(checksum, sizeof(checksum), "%08x", sSimChecksum);
+    if (doChecksum)
+    {
+        printf("%s\n", checksum);
+    }
+    if ( (golden != NULL) && (strcasecmp(golden, checksum) != 0) )
+    {
+        fprintf(stderr, "ledsim: checksum mismatch: %s (expected %s)\n", checksum, golden);
+        return 1;
+    }
+
+    return 0;
+}
+
+/* *********************************************************************************************** */
+// eof
@@ -0,0 +1,111 @@
+#!/bin/bash
+#
+# flipflip's Tschenggins Lämpli: build and run the LED simulator (see ledsim.cpp)
+#
+# Copyright (c) 2020 Philippe Kehl (flipflip at oinkzwurgl dot org),
+# https://oinkzwurgl.org/projaeggd/tschenggins-laempli
+#
+# Usage:
+#
+#   ./ledsim.sh [-l <numLeds>[/<numStrips>]] [<ledsim args>]   build (with <numLeds> LEDs, on <numStrips> strips) and run, e.g.:
+#   ./ledsim.sh -t -d sk9822 -b low              terminal preview
+#   ./ledsim.sh -l 100 -p /tmp/frames            write images
+#   ./ledsim.sh -l 40/2 -t -D ws2812 -O grb      terminal preview, two strips with different drivers
+#   ./ledsim.sh bench                            benchmark for a few numbers of LEDs
+#   ./ledsim.sh check                            check the flicker distributions, the lookup tables, the still refresh and compare to golden.txt
+#                                                (with the asynchronous and the synchronous SPI output)
+#   ./ledsim.sh golden                           update golden.txt (after checking the changes!)
+#
+# Environment: CXX (default g++), CC (default gcc), CXXFLAGS (default -O2), BUILDDIR (default /tmp/ledsim),
+#              DEFS (additional defines, e.g. -DCONFIG_LEDS_SPI_ASYNC=0)
+
+set -e
+
+DIR=$(cd "$(dirname "$0")" && pwd)
+SRC=$DIR/../../src
+CXX=${CXX:-g++}
+CC=${CC:-gcc}
+CXXFLAGS=${CXXFLAGS:--O2}
+BUILDDIR=${BUILDDIR:-/tmp/ledsim}
+
+# build the simulator for numLeds LEDs (empty = default), optionally on two strips ("<numLeds>/2"), prints the
+# executable path
+build()
+{
+    local numLeds=${1%%/*}
+    local numStrips=""
+    if [ "$1" != "$numLeds" ]; then
+        numStrips=${1#*/}
+    fi
+    local exe=$BUILDDIR/ledsim${numLeds:+-$numLeds}${numStrips:+x$numStrips}
+    local defs="-DESP32 $DEFS ${numLeds:+-DCONFIG_LEDS_NUM=$numLeds} ${numStrips:+-DCONFIG_LEDS_STRIPS=$numStrips}"
+    mkdir -p "$BUILDDIR"
+    $CC $CXXFLAGS $defs -I"$DIR/stubs" -c "$SRC/hsv2rgb.c" -o "$BUILDDIR/hsv2rgb.o" >&2
+    $CXX $CXXFLAGS $defs -Wall -Wno-sign-compare -Wno-format -I"$DIR/stubs" "$DIR/ledsim.cpp" "$BUILDDIR/hsv2rgb.o" -o "$exe" >&2
+    echo "$exe"
+}
+
+# run the configurations in golden.txt (<numLeds> <checksum> <ledsim args>), "check" or "update"
+golden()
+{
+    local mode=$1
+    local res=0
+    local out=""
+    while read -r numLeds checksum args; do
+        if [ -z "$numLeds" ] || [ "${numLeds:0:1}" = "#" ]; then
+            out="$out$numLeds $checksum $args"$'\n'
+            continue
+        fi
+        local exe
+        exe=$(build "$numLeds")
+        local sum=$("$exe" -c $args)
+        if [ "$mode" = "update" ]; then
+            echo "$numLeds $sum $args"
+        elif [ "$sum" = "$checksum" ]; then
+            echo "ok   $numLeds $args"
+        else
+            echo "FAIL $numLeds $args: $sum (expected $checksum)"
+            res=1
+        fi
+        out="$out$numLeds $sum $args"$'\n'
+    done < "$DIR/golden.txt"
+    if [ "$mode" = "update" ]; then
+        printf "%s" "$out" > "$DIR/golden.txt"
+    fi
+    return $res
+}
+
+case "$1" in
+    bench)
+        for numLeds in 20 50 100 150 300 300/2; do
+            exe=$(build $numLeds)
+            "$exe" -B -n 10000 -d ws2801
+            "$exe" -B -n 10000 -d sk9822
+            "$exe" -B -n 10000 -d ws2812
+        done
+        "$(build)" -H
+        ;;
+    check)
+        "$(build)" -F
+        "$(build)" -L
+        "$(build)" -S -b low
+        "$(build)" -S -b medium -d sk9822
+        golden check
+        # the same with the synchronous SPI output
+        BUILDDIR=$BUILDDIR/sync DEFS="-DCONFIG_LEDS_SPI_ASYNC=0" golden check
+        ;;
+    golden)
+        golden update
+        ;;
+    *)
+        numLeds=""
+        if [ "$1" = "-l" ]; then
+            numLeds=$2
+            shift 2
+        fi
+        exe=$(build "$numLeds")
+        exec "$exe" "$@"
+        ;;
+esac
+
+# eof
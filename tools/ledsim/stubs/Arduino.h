@@ -0,0 +1,68 @@
+/*!
+    \file
+    \brief flipflip's Tschenggins Lämpli: LED simulator, minimal Arduino environment (see ledsim.cpp)
+
+    - Copyright (c) 2020 Philippe Kehl (flipflip at oinkzwurgl dot org),
+      https://oinkzwurgl.org/projaeggd/tschenggins-laempli
+*/
+
+#ifndef __ARDUINO_H__
+#define __ARDUINO_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <ctype.h>
+#include <math.h>
+
+#define PROGMEM
+#define PSTR(s)       (s)
+#define memcpy_P      memcpy
+#define strcmp_P      strcmp
+#define strstr_P      strstr
+#define snprintf_P    snprintf
+#define pgm_read_byte(p) (*(const uint8_t *)(p))
+
+#define IRAM_ATTR
+#define ICACHE_RAM_ATTR
+
+#define HIGH 0x1
+#define LOW  0x0
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// simulated time (advanced by delay() and by the simulator)
+uint32_t micros(void);
+uint32_t millis(void);
+void delay(uint32_t ms);
+void delayMicroseconds(uint32_t us);
+
+#ifdef __cplusplus
+}
+
+// debug output (only shown with -v)
+class SimSerial
+{
+    public:
+        int printf_P(const char *fmt, ...) __attribute__ ((format (printf, 2, 3)));
+        void flush(void);
+};
+extern SimSerial Serial;
+
+// the cycle counter runs on the host clock, one "cycle" per nanosecond
+class SimEsp
+{
+    public:
+        uint32_t getCycleCount(void);
+        uint32_t getCpuFreqMHz(void);
+};
+extern SimEsp ESP;
+#endif
+
+#endif // __ARDUINO_H__
+// eof
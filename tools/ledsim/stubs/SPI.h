@@ -0,0 +1,34 @@
+/*!
+    \file
+    \brief flipflip's Tschenggins Lämpli: LED simulator, SPI capturing the bytes sent (see ledsim.cpp)
+
+    - Copyright (c) 2020 Philippe Kehl (flipflip at oinkzwurgl dot org),
+      https://oinkzwurgl.org/projaeggd/tschenggins-laempli
+*/
+
+#ifndef __SPI_H__
+#define __SPI_H__
+
+#include <Arduino.h>
+
+#define HSPI 2
+#define VSPI 3
+
+void ledsimSpiWrite(const uint8_t bus, const uint8_t *data, const int size);
+
+class SPIClass
+{
+    public:
+        SPIClass(uint8_t bus = VSPI) : _bus(bus) { }
+        void begin(int8_t sck = -1, int8_t miso = -1, int8_t mosi = -1, int8_t ss = -1)
+            { (void)sck; (void)miso; (void)mosi; (void)ss; }
+        void setFrequency(uint32_t freq) { (void)freq; }
+        void writeBytes(const uint8_t *data, uint32_t size) { ledsimSpiWrite(_bus, data, size); }
+    private:
+        uint8_t _bus;
+};
+
+static SPIClass SPI(VSPI);
+
+#endif // __SPI_H__
+// eof
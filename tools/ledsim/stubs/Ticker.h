@@ -0,0 +1,19 @@
+/*!
+    \file
+    \brief flipflip's Tschenggins Lämpli: LED simulator, Ticker (the simulator runs the task itself)
+
+    - Copyright (c) 2020 Philippe Kehl (flipflip at oinkzwurgl dot org),
+      https://oinkzwurgl.org/projaeggd/tschenggins-laempli
+*/
+
+#ifndef __TICKER_H__
+#define __TICKER_H__
+
+class Ticker
+{
+    public:
+        void attach_ms(uint32_t ms, void (*callback)(void)) { (void)ms; (void)callback; }
+};
+
+#endif // __TICKER_H__
+// eof
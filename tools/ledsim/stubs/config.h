@@ -0,0 +1,13 @@
+// LED simulator config, the same as for the ESP32 target (see tools/gen_config_h.pl)
+
+#ifndef __CONFIG_H__
+#define __CONFIG_H__
+
+#define CONFIG_VERSION_GIT_HASH "ledsim"
+#define CONFIG_VERSION_YYYYMMDD "0000-00-00"
+#define CONFIG_VERSION_HHMMSS   "00:00:00"
+
+#include "../../../src/config-common.txt"
+#include "../../../src/config-esp32-gitta.txt"
+
+#endif
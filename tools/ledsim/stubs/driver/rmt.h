@@ -0,0 +1,48 @@
+/*!
+    \file
+    \brief flipflip's Tschenggins Lämpli: LED simulator, RMT capturing the items sent (see ledsim.cpp)
+
+    - Copyright (c) 2020 Philippe Kehl (flipflip at oinkzwurgl dot org),
+      https://oinkzwurgl.org/projaeggd/tschenggins-laempli
+*/
+
+#ifndef __DRIVER_RMT_H__
+#define __DRIVER_RMT_H__
+
+#include <Arduino.h>
+#include <esp_err.h>
+
+typedef int gpio_num_t;
+typedef enum { RMT_CHANNEL_0 = 0, RMT_CHANNEL_1 = 1 } rmt_channel_t;
+typedef enum { RMT_MODE_TX = 0 } rmt_mode_t;
+typedef enum { RMT_IDLE_LEVEL_LOW = 0 } rmt_idle_level_t;
+typedef struct { uint32_t val; } rmt_item32_t;
+typedef struct
+{
+    rmt_mode_t    rmt_mode;
+    rmt_channel_t channel;
+    gpio_num_t    gpio_num;
+    uint8_t       clk_div;
+    uint8_t       mem_block_num;
+    struct
+    {
+        bool             idle_output_en;
+        rmt_idle_level_t idle_level;
+    } tx_config;
+} rmt_config_t;
+
+void ledsimRmtWrite(const rmt_channel_t ch, const uint32_t *items, const int num);
+
+static inline esp_err_t rmt_config(const rmt_config_t *cfg) { (void)cfg; return ESP_OK; }
+static inline esp_err_t rmt_driver_install(rmt_channel_t ch, size_t rxSize, int flags) { (void)ch; (void)rxSize; (void)flags; return ESP_OK; }
+static inline esp_err_t rmt_driver_uninstall(rmt_channel_t ch) { (void)ch; return ESP_OK; }
+static inline esp_err_t rmt_wait_tx_done(rmt_channel_t ch, uint32_t wait) { (void)ch; (void)wait; return ESP_OK; }
+static inline esp_err_t rmt_write_items(rmt_channel_t ch, const rmt_item32_t *items, int num, bool wait)
+{
+    (void)wait;
+    ledsimRmtWrite(ch, (const uint32_t *)items, num);
+    return ESP_OK;
+}
+
+#endif // __DRIVER_RMT_H__
+// eof
@@ -0,0 +1,116 @@
+/*!
+    \file
+    \brief flipflip's Tschenggins Lämpli: LED simulator, SPI master driver capturing the bytes sent (see ledsim.cpp)
+
+    - Copyright (c) 2020 Philippe Kehl (flipflip at oinkzwurgl dot org),
+      https://oinkzwurgl.org/projaeggd/tschenggins-laempli
+
+    Queued transactions are sent (captured) right away and are done by the time they are collected.
+*/
+
+#ifndef __DRIVER_SPI_MASTER_H__
+#define __DRIVER_SPI_MASTER_H__
+
+#include <Arduino.h>
+#include <SPI.h>
+#include <esp_err.h>
+
+typedef enum { SPI_HOST = 0, HSPI_HOST = 1, VSPI_HOST = 2 } spi_host_device_t;
+
+typedef struct
+{
+    int mosi_io_num;
+    int miso_io_num;
+    int sclk_io_num;
+    int quadwp_io_num;
+    int quadhd_io_num;
+    int max_transfer_sz;
+} spi_bus_config_t;
+
+typedef struct
+{
+    uint8_t mode;
+    int     clock_speed_hz;
+    int     spics_io_num;
+    int     queue_size;
+} spi_device_interface_config_t;
+
+typedef struct
+{
+    uint32_t    flags;
+    size_t      length;    // [bits]
+    size_t      rxlength;  // [bits]
+    void       *user;
+    const void *tx_buffer;
+    void       *rx_buffer;
+} spi_transaction_t;
+
+typedef struct spi_device_s
+{
+    spi_host_device_t  host;
+    int                maxTransferSize;
+    int                queueSize;
+    spi_transaction_t *queue[8];
+    int                numQueued;
+} *spi_device_handle_t;
+
+static struct spi_device_s sLedsimSpiDevs[3];
+static int sLedsimSpiMaxTransferSize[3];
+
+static inline esp_err_t spi_bus_initialize(spi_host_device_t host, const spi_bus_config_t *busCfg, int dmaChan)
+{
+    if ( (host == SPI_HOST) || (dmaChan < 1) || (dmaChan > 2) || (sLedsimSpiMaxTransferSize[host] != 0) )
+    {
+        return ESP_FAIL;
+    }
+    sLedsimSpiMaxTransferSize[host] = busCfg->max_transfer_sz;
+    return ESP_OK;
+}
+
+static inline esp_err_t spi_bus_add_device(spi_host_device_t host, const spi_device_interface_config_t *devCfg,
+    spi_device_handle_t *pHandle)
+{
+    if ( (sLedsimSpiMaxTransferSize[host] == 0) || (devCfg->queue_size < 1) || (devCfg->queue_size > 8) )
+    {
+        return ESP_FAIL;
+    }
+    spi_device_handle_t dev = &sLedsimSpiDevs[host];
+    dev->host            = host;
+    dev->maxTransferSize = sLedsimSpiMaxTransferSize[host];
+    dev->queueSize       = devCfg->queue_size;
+    dev->numQueued       = 0;
+    *pHandle = dev;
+    return ESP_OK;
+}
+
+static inline esp_err_t spi_device_queue_trans(spi_device_handle_t dev, spi_transaction_t *pTrans, uint32_t wait)
+{
+    (void)wait;
+    if (dev->numQueued >= dev->queueSize)
+    {
+        return ESP_ERR_TIMEOUT;
+    }
+    if ( ((pTrans->length % 8) != 0) || ((int)(pTrans->length / 8) > dev->maxTransferSize) )
+    {
+        return ESP_FAIL;
+    }
+    ledsimSpiWrite(dev->host == HSPI_HOST ? HSPI : VSPI, (const uint8_t *)pTrans->tx_buffer, pTrans->length / 8);
+    dev->queue[dev->numQueued++] = pTrans;
+    return ESP_OK;
+}
+
+static inline esp_err_t spi_device_get_trans_result(spi_device_handle_t dev, spi_transaction_t **ppTrans, uint32_t wait)
+{
+    (void)wait;
+    if (dev->numQueued <= 0)
+    {
+        return ESP_ERR_TIMEOUT;
+    }
+    *ppTrans = dev->queue[0];
+    dev->numQueued--;
+    memmove(&dev->queue[0], &dev->queue[1], dev->numQueued * sizeof(dev->queue[0]));
+    return ESP_OK;
+}
+
+#endif // __DRIVER_SPI_MASTER_H__
+// eof
@@ -0,0 +1,13 @@
+// LED simulator: ESP-IDF error codes (and the FreeRTOS bits the drivers need)
+
+#ifndef __ESP_ERR_H__
+#define __ESP_ERR_H__
+
+typedef int esp_err_t;
+#define ESP_OK          0
+#define ESP_FAIL        -1
+#define ESP_ERR_TIMEOUT 0x107
+
+#define portMAX_DELAY 0xffffffff
+
+#endif
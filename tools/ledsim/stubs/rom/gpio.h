@@ -0,0 +1,11 @@
+// LED simulator: GPIO matrix (not needed)
+
+#ifndef __ROM_GPIO_H__
+#define __ROM_GPIO_H__
+
+static inline void gpio_matrix_out(uint32_t gpio, uint32_t signal, bool outInv, bool oenInv)
+{
+    (void)gpio; (void)signal; (void)outInv; (void)oenInv;
+}
+
+#endif
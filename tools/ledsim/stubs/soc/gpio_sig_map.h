@@ -0,0 +1,9 @@
+// LED simulator: GPIO signals
+
+#ifndef __SOC_GPIO_SIG_MAP_H__
+#define __SOC_GPIO_SIG_MAP_H__
+
+#define HSPID_OUT_IDX 8
+#define VSPID_OUT_IDX 64
+
+#endif
@@ -84,6 +84,8 @@ The following parameters are used in the commands described below.
 
 =item * C<limit> -- limit of list of results (default 0, i.e. all)
 
+=item * C<longpoll> -- long-poll generation (for C<cmd=realtime>, default: none, i.e. streaming)
+
 =item * C<maxch> -- maximum number of channels the client can handle (default 10)
 
 =item * C<name> -- client or job name
@@ -129,6 +131,7 @@ The following parameters are used in the commands described below.
     my $stassid  = $q->param('stassid')  || '';
     my $version  = $q->param('version')  || '';
     my $maxch    = $q->param('maxch')    || 10;
+    my $longpoll = $q->param('longpoll') // -1;
     my $chunked  = $q->param('chunked')  || 0;
     my @states   = (); # $q->multi_param('states');
     my $model    = $q->param('model')    || '';
@@ -136,7 +139,13 @@ The following parameters are used in the commands described below.
     my $order    = $q->param('order')    || '';
     my $bright   = $q->param('bright')   || '';
     my $noise    = $q->param('noise')    || '';
+    my $leds     = $q->param('leds')     || '';
+    my $hues     = $q->param('hues')     || '';
+    my $driver2  = $q->param('driver2')  || '';
+    my $order2   = $q->param('order2')   || '';
+    my $running  = $q->param('running')  || '';
     my $cfgcmd   = $q->param('cfgcmd')   || '';
+    my $report   = $q->param('report')   || '';
 
     # application/json POST
     my $contentType = $q->content_type();
@@ -156,6 +165,7 @@ The following parameters are used in the commands described below.
     $q->param('debug', 1) if ($debug);
     DEBUG("cmd=%s user=%s", $cmd, $ENV{'REMOTE_USER'} || 'anonymous');
     $chunked = 0 if ($chunked !~ m{^\d+$}); # positive integers only
+    $longpoll = -1 if ($longpoll !~ m{^\d+$}); # positive integers only
 
 
     ##### output is HTML, JSON or text #####
@@ -282,7 +292,7 @@ This can be used to implement a polling client (but see C<cmd=realtime> for some
 
 =pod
 
-=item B<<  C<< cmd=realtime client=<clientid> [name=<client name>] [staip=<client station IP>] [stassid=<client station SSID>] [version=<client sw version>] [strlen=<number>] [maxch=<number>] >> >>
+=item B<<  C<< cmd=realtime client=<clientid> [name=<client name>] [staip=<client station IP>] [stassid=<client station SSID>] [version=<client sw version>] [strlen=<number>] [maxch=<number>] [longpoll=<generation>] >> >>
 
 Returns info for a client and updates client info. This is persistent connection with real-time
 update as things happen (i.e. the web server will keep sending).
@@ -313,6 +323,21 @@ The "hello" is is followed by the C<client> ID, C<strlen> and the client C<name>
 first "heartbeat", the "config" and the "status" are sent immediately. From then on heartbeats will
 follow every 5 seconds. The status is sent as needed, i.e. as soon as something changes.
 
+After four hours a "reconnect" is sent. The connection is kept open for another 30 seconds or until
+the client has opened a new connection, so that the client can switch over without losing state.
+
+With C<longpoll> the request is held open only until something changes (or for at most 55 seconds)
+and then ends with a "poll" line that carries the new generation:
+
+    poll 1545832449 42\r\n
+
+The long-poll response is sent in one go, with a Content-Length, so that the web server can keep the
+connection open (HTTP keep-alive) for the next request.
+
+The next request should pass that generation. The response then only contains what has changed
+since. Unknown generations (e.g. 0) get the full config and status. This is for clients behind
+proxies that buffer the endless response.
+
 Note how the first "status" lists all configured channels (jobs) and how subsequent updates only
 list the changed job(s). The C<strlen> corresponds to the maximum length of individual strings in
 the JSON "config" data, not the whole response line.
@@ -325,11 +350,15 @@ To test use something like C<curl "https://..../tschenggins-status2.pl?cmd=realt
     {
         # dummy call like cmd=leds to check the parameters and update the client info in the DB
         ($data, $error) = _jobs($db, $client, $strlen,
-            { name => $name, staip => $staip, stassid => $stassid, version => $version, maxch => $maxch });
+            { name => $name, staip => $staip, stassid => $stassid, version => $version, maxch => $maxch,
+              mode => ($longpoll < 0 ? 'stream' : 'longpoll') });
 
-        # clear pending commands
-        $db->{cmd}->{$client} = '';
-        $db->{_dirtiness}++;
+        # clear pending commands (but keep them for the next long-poll request)
+        if ($longpoll < 0)
+        {
+            $db->{cmd}->{$client} = '';
+            $db->{_dirtiness}++;
+        }
 
         # save pid so that previous instances can terminate in case they're still running
         # and haven't noticed yet that the Lämpli is gone (Apache waiting "forever" for TCP timeout)
@@ -344,6 +373,30 @@ To test use something like C<curl "https://..../tschenggins-status2.pl?cmd=realt
 
 =pod
 
+=item B<<  C<< cmd=report client=<clientid> report=<...> >> >>
+
+Stores a report from the client (e.g. the LED profile, see the "profile" command) in the client info,
+where the web interface shows it.
+
+=cut
+
+    elsif ($cmd eq 'report')
+    {
+        if ($client && $db->{clients}->{$client} && ($report =~ m{^[-a-zA-Z0-9:/,.@]+$}))
+        {
+            $db->{clients}->{$client}->{report}   = $report;
+            $db->{clients}->{$client}->{reportts} = int(time());
+            $db->{_dirtiness}++;
+            $text = "client $client report stored";
+        }
+        else
+        {
+            $error = 'illegal parameter';
+        }
+    }
+
+=pod
+
 =back
 
 =head3 Web Interface Commands
@@ -515,16 +568,23 @@ Set client jobs configuration.
         }
     }
 
-=item B<<  C<< cmd=cfgdevice client=<clientid> model=<...> driver=<...> order=<...> bright=<...> noise=<...> name=<...> >> >>
+=item B<<  C<< cmd=cfgdevice client=<clientid> model=<...> driver=<...> order=<...> bright=<...> noise=<...> name=<...> [leds=<...>] [hues=<...>] [driver2=<...>] [order2=<...>] [running=<...>] >> >>
 
-Set client device configuration.
+Set client device configuration. The optional C<leds> maps channels to LEDs, e.g. C<0-4;5-9;10,12-14> shows
+channel 0 on LEDs 0..4, channel 1 on LEDs 5..9 and channel 2 on LEDs 10 and 12..14 (default: one LED per
+channel). The optional C<hues> selects the hue to colour mapping, C<classic> (default) or C<rainbow> (more
+yellow and orange, less cyan). The optional C<driver2> and C<order2> configure the second LED strip of
+lämplis built with two strips (default: the same as the first strip). The optional C<running> selects the
+effect for running jobs, C<pulse> (default), C<rotate>, C<chase> or C<comet> (the latter three move along a
+channel's LEDs, laid out by a suffix to its LEDs in C<leds>: C<r> = ring, C<l> = line, C<m4> = matrix with 4
+columns, e.g. C<0-11r;12-19l>).
 
 =cut
 
     # set client device configuration
     elsif ($cmd eq 'cfgdevice')
     {
-        DEBUG("cfg $client $model $driver $order $bright $noise $name");
+        DEBUG("cfg $client $model $driver $order $bright $noise $name $leds $hues $driver2 $order2 $running");
         if ($client && $db->{config}->{$client}) # && $model && $driver && $order && $bright && $noise && $name)
         {
             $db->{config}->{$client}->{model}  = $model;
@@ -534,8 +594,14 @@ Set client device configuration.
             $db->{config}->{$client}->{noise}  = $noise;
             $name =~ s{[^a-z0-9A-Z]}{_}g;
             $db->{config}->{$client}->{name}   = substr($name, 0, 20);
+            $leds =~ s{[^0-9,;rlm-]}{}g;
+            $db->{config}->{$client}->{leds}   = substr($leds, 0, 150);
+            $db->{config}->{$client}->{hues}   = ($hues eq 'rainbow' ? 'rainbow' : 'classic');
+            $db->{config}->{$client}->{driver2} = $driver2;
+            $db->{config}->{$client}->{order2}  = $order2;
+            $db->{config}->{$client}->{running} = ($running =~ m{^(rotate|chase|comet)$} ? $running : 'pulse');
             $db->{_dirtiness}++;
-            $text = "client $client set config $model $driver $order $bright $noise $name";
+            $text = "client $client set config $model $driver $order $bright $noise $name $leds $hues $driver2 $order2 $running";
             # signal server
             if ($db->{clients}->{$client}->{pid})
             {
@@ -616,7 +682,8 @@ variable.
 
     if ( !$error && ($cmd eq 'realtime') )
     {
-        _realtime($client, $strlen, { name => $name, staip => $staip, stassid => $stassid, version => $version }); # this doesn't return
+        _realtime($client, $strlen, { name => $name, staip => $staip, stassid => $stassid, version => $version,
+                                      mode => ($longpoll < 0 ? 'stream' : 'longpoll') }, $longpoll); # this doesn't return
         exit(0);
     }
 
@@ -1039,8 +1106,30 @@ sub _jobs
 # curl --raw -s -v -i "http://..../tschenggins-status.pl?cmd=realtime;client=...;debug=1"
 sub _realtime
 {
-    my ($client, $strlen, $info) = @_;
-    print($q->header(-type => 'text/plain', -expires => 'now', charset => 'US-ASCII'));
+    my ($client, $strlen, $info, $longpoll) = @_;
+
+    # long-poll: collect the response and send it with a Content-Length at the end, so that the connection can
+    # be kept open for the next request (saves the client a TLS handshake per poll)
+    my $lpBody = '';
+    if ($longpoll >= 0)
+    {
+        open(my $lpFh, '>', \$lpBody) || die($!);
+        select($lpFh);
+    }
+    my $done = sub
+    {
+        if ($longpoll >= 0)
+        {
+            select(STDOUT);
+            print($q->header(-type => 'text/plain', -expires => 'now', charset => 'US-ASCII',
+                             '-Content-Length' => length($lpBody)), $lpBody);
+        }
+        exit(0);
+    };
+    if ($longpoll < 0)
+    {
+        print($q->header(-type => 'text/plain', -expires => 'now', charset => 'US-ASCII'));
+    }
     my $n = 0;
     my $nHeartbeat = 0;
     my $lastTs = 0;
@@ -1048,6 +1137,7 @@ sub _realtime
     my $lastConfig = 'not a possible config string';
     my $lastCheck = 0;
     my $startTs = time();
+    my $endTs = 0;
     my $debugServer = ($q->param('debug') || 0) > 1 ? 1 : 0;
     my $doCheck = 0;
     $SIG{USR1} = sub { $doCheck = 1; };
@@ -1056,6 +1146,21 @@ sub _realtime
     STDOUT->autoflush(1);
     print("\r\nhello $client $strlen $info->{name}\r\n");
 
+    # long-poll: continue where the previous request left off, or start over if the client missed something
+    my $lpGen = 0;
+    if ($longpoll >= 0)
+    {
+        my ($dbHandle, $db, $error) = _dbOpen();
+        my $clientInfo = $db && $db->{clients}->{$client} ? $db->{clients}->{$client} : {};
+        $lpGen = $clientInfo->{lpgen} || 0;
+        if ($lpGen && ($longpoll == $lpGen))
+        {
+            @lastStatus = @{$clientInfo->{lpstatus} || []};
+            $lastConfig = $clientInfo->{lpconfig} // $lastConfig;
+        }
+        _dbClose($dbHandle, $db, 0, 0);
+    }
+
     while (1)
     {
         sleep(1);
@@ -1068,10 +1173,19 @@ sub _realtime
         }
         $n++;
 
-        # don't run forever
+        # don't run forever, ask the client to reconnect and give it some time to connect again before we go
+        # (we'll get the "no longer in charge" below as soon as the new connection is there)
         if ( ($now - $startTs) > (4 * 3600) )
         {
-            exit(0);
+            if (!$endTs)
+            {
+                print("\r\nreconnect $nowInt\r\n");
+                $endTs = $now + 30;
+            }
+            elsif ($now > $endTs)
+            {
+                $done->();
+            }
         }
 
         # check database...
@@ -1125,14 +1239,16 @@ sub _realtime
                 printf(STDERR "client info gone\n") if ($debugServer);
                 print("\r\nreconnect $nowInt\r\n");
                 sleep(1);
-                exit(0);
+                $done->();
             }
 
             # send command?
+            my $sent = 0;
             if ($sendCmd)
             {
                 printf(STDERR "client command $sendCmd\n") if ($debugServer);
                 print("\r\ncommand $nowInt $sendCmd\r\n");
+                $sent++;
             }
 
             # check if we're interested in any changes
@@ -1146,6 +1262,7 @@ sub _realtime
                     my $json = _jsonEncode(\%data, 1, 0);
                     print("\r\nconfig $nowInt $json\r\n");
                     $lastConfig = $config;
+                    $sent++;
                 }
             }
             if ($db && $db->{clients} && $db->{clients}->{$client})
@@ -1177,9 +1294,27 @@ sub _realtime
                     {
                         my $json = _jsonEncode(\@changedJobs, 1, 0);
                         print("\r\nstatus $nowInt $json\r\n");
+                        $sent++;
                     }
                 }
             }
+
+            # long-poll: remember what the client has seen and end the response
+            if ( ($longpoll >= 0) && ($sent || (($now - $startTs) > 55)) )
+            {
+                my ($dbHandle, $db, $error) = _dbOpen();
+                if (!$error && $db->{clients}->{$client})
+                {
+                    $lpGen++;
+                    $db->{clients}->{$client}->{lpgen}    = $lpGen;
+                    $db->{clients}->{$client}->{lpstatus} = \@lastStatus;
+                    $db->{clients}->{$client}->{lpconfig} = $lastConfig;
+                    $db->{_dirtiness}++;
+                }
+                _dbClose($dbHandle, $db, 0, $error ? 0 : 1);
+                print("\r\npoll $nowInt $lpGen\r\n");
+                $done->();
+            }
         }
 
         # FIXME: if we just could read some data from the client here to determine if it is still alive..
@@ -1598,6 +1733,7 @@ sub _gui_clients
         my $staIp    = $client->{staip} || 'unknown';
         my $staSsid  = $client->{stassid} || 'unknown';
         my $version  = $client->{version} || 'unknown';
+        my $mode     = $client->{mode} || 'unknown';
         my $edit     = $q->span({ -class => 'action action-configure-client', -data_clientid => $clientId }, 'configure');
 
         my @leds = ();
@@ -1618,6 +1754,7 @@ sub _gui_clients
                           $q->td({ -class => "$online center nowrap", -data_sort => "$online $pid" }, "$pid ($check)"),
                           $q->td({ -class => 'center nowrap' }, $staIp),
                           $q->td({ -align => 'center nowrap' }, $staSsid),
+                          $q->td({ -class => 'center' }, $mode),
                           $q->td({ }, $cfgModel),
                           $q->td({ -class => 'center' }, $version), $q->td({}, $edit)));
     }
@@ -1633,6 +1770,7 @@ sub _gui_clients
                                         $q->th({ -class => 'sort' }, 'PID'),
                                         $q->th({ -class => 'sort nowrap' }, 'Sta IP'),
                                         $q->th({ -class => 'sort nowrap' }, 'Sta SSID'),
+                                        $q->th({ -class => 'sort' }, 'Mode'),
                                         $q->th({ -class => 'sort' }, 'Model'),
                                         $q->th({ -class => 'sort' }, 'Version'),
                                         $q->th({}, 'Actions'),
@@ -1732,7 +1870,7 @@ sub __gui_config_client
     my $driverSelectArgs =
     {
         -name         => 'driver',
-        -values       => [ '', 'none', 'WS2801', 'SK9822' ],
+        -values       => [ '', 'none', 'WS2801', 'WS2812', 'SK9822' ],
         -autocomplete => 'off',
         -default      => ($config->{driver} || ''),
     };
@@ -1745,6 +1883,22 @@ sub __gui_config_client
         -autocomplete => 'off',
         -default      => ($config->{order} || ''),
     };
+    my $driver2SelectArgs =
+    {
+        -name         => 'driver2',
+        -values       => [ '', 'WS2801', 'WS2812', 'SK9822' ],
+        -labels       => { '' => '(same)' },
+        -autocomplete => 'off',
+        -default      => ($config->{driver2} || ''),
+    };
+    my $order2SelectArgs =
+    {
+        -name         => 'order2',
+        -values       => [ '', qw(RGB RBG GRB GBR BRG BGR) ],
+        -labels       => { '' => '(same)' },
+        -autocomplete => 'off',
+        -default      => ($config->{order2} || ''),
+    };
     my $brightSelectArgs =
     {
         -name         => 'bright',
@@ -1759,6 +1913,29 @@ sub __gui_config_client
         -autocomplete => 'off',
         -default      => ($config->{noise} || ''),
     };
+    my $huesSelectArgs =
+    {
+        -name         => 'hues',
+        -values       => [ qw(classic rainbow) ],
+        -autocomplete => 'off',
+        -default      => ($config->{hues} || 'classic'),
+    };
+    my $runningSelectArgs =
+    {
+        -name         => 'running',
+        -values       => [ qw(pulse rotate chase comet) ],
+        -autocomplete => 'off',
+        -default      => ($config->{running} || 'pulse'),
+    };
+    my $ledsInputArgs =
+    {
+        -type         => 'text',
+        -name         => 'leds',
+        -size         => 20,
+        -value        => ($config->{leds} || ''),
+        -autocomplete => 'off',
+        -placeholder  => '0-4;5-9;10,12-14',
+    };
     my $nameInputArgs =
     {
         -type         => 'text',
@@ -1775,7 +1952,12 @@ sub __gui_config_client
                         $q->Tr({}, $q->td({}, 'Lämpli Model:'), $q->td({}, $q->popup_menu($modelSelectArgs))),
                         $q->Tr({}, $q->td({}, 'LED Driver:'), $q->td({}, $q->popup_menu($driverSelectArgs))),
                         $q->Tr({}, $q->td({}, 'LED Colours:'), $q->td({}, $q->popup_menu($orderSelectArgs))),
+                        $q->Tr({}, $q->td({}, 'LED Driver (2nd strip):'), $q->td({}, $q->popup_menu($driver2SelectArgs))),
+                        $q->Tr({}, $q->td({}, 'LED Colours (2nd strip):'), $q->td({}, $q->popup_menu($order2SelectArgs))),
                         $q->Tr({}, $q->td({}, 'LED Brightness:'), $q->td({}, $q->popup_menu($brightSelectArgs))),
+                        $q->Tr({}, $q->td({}, 'LED Hues:'), $q->td({}, $q->popup_menu($huesSelectArgs))),
+                        $q->Tr({}, $q->td({}, 'LED Mapping:'), $q->td({}, $q->input($ledsInputArgs))),
+                        $q->Tr({}, $q->td({}, 'Running Jobs:'), $q->td({}, $q->popup_menu($runningSelectArgs))),
                         $q->Tr({}, $q->td({}, 'Noise Level:'), $q->td({}, $q->popup_menu($noiseSelectArgs))),
                         $q->Tr({}, $q->td({}, 'Lämpli Name:'), $q->td({}, $q->input($nameInputArgs))),
                         $q->Tr({ }, $q->td({ -colspan => 2, -align => 'center' }, $q->submit(-value => 'save config'))),
@@ -1819,7 +2001,7 @@ sub __gui_config_client
         $q->hidden(-name => 'cfgcmd', -default => $_),
         $q->submit(-value => $_),
         $q->end_form(),
-    } qw(reset reconnect identify random chewie hello dummy);
+    } qw(reset reconnect identify random chewie hello profile dummy);
     my $htmlCommands =
       $q->div({  },
               $q->table({},
@@ -1844,7 +2026,7 @@ sub __gui_config_client
                         $q->Tr({}, $q->th({ -colspan => 2 }, 'Client Info')),
                         (map { $q->Tr({},
                                       $q->td({}, $_),
-                                      $q->td({}, $_ =~ m{^(ts|check)$} ?  $client->{$_} . ' (' . _age_str(time(), $client->{$_}) . ')' : $client->{$_})
+                                      $q->td({}, $_ =~ m{^(ts|check|reportts)$} ?  $client->{$_} . ' (' . _age_str(time(), $client->{$_}) . ')' : $client->{$_})
                                      ) } sort keys %{$client}),
                         #(map { $q->Tr({}, $q->th({}, $_), $q->td({}, $config->{$_})) } sort keys %{$config}),
                        ),